@@ -0,0 +1,549 @@
+#ifndef _CONCURRENTQUEUE_NOSLIB_HPP_
+#define _CONCURRENTQUEUE_NOSLIB_HPP_
+
+#include <atomic>
+#include <thread>
+#include <cstdint>
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <type_traits>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace NosLib
+{
+	/// <summary>
+	/// assumed cache line size, used to keep variables written by different threads on separate lines (false sharing)
+	/// </summary>
+	constexpr size_t CacheLineSize = 64;
+
+	/// <summary>
+	/// exponential backoff for spin loops, pauses the cpu a growing amount of times and then starts yielding the thread
+	/// </summary>
+	class Backoff
+	{
+	protected:
+		static constexpr unsigned int YieldStep = 6; /* after 2^6 pauses per round, start yielding */
+		unsigned int Step = 0;
+
+	public:
+		/// <summary>
+		/// tells the cpu we are in a spin loop (saves power and lets the other hyperthread run)
+		/// </summary>
+		static inline void CpuRelax()
+		{
+		#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+			_mm_pause();
+		#elif defined(__aarch64__) || defined(__arm__)
+			__asm__ __volatile__("yield");
+		#else
+			std::this_thread::yield();
+		#endif
+		}
+
+		inline void Pause()
+		{
+			if (Step <= YieldStep)
+			{
+				for (unsigned int i = 0; i < (1u << Step); i++)
+				{
+					CpuRelax();
+				}
+				Step++;
+			}
+			else
+			{
+				std::this_thread::yield();
+			}
+		}
+
+		inline void Reset()
+		{
+			Step = 0;
+		}
+	};
+
+	/// <summary>
+	/// Bounded lock free multi producer multi consumer queue (Dmitry Vyukov's design). every slot carries a sequence number
+	/// which tells producers and consumers whose turn it is, so neither side ever takes a lock
+	/// </summary>
+	/// <typeparam name="QueueDataType">- datatype stored in the queue (has to be move constructible)</typeparam>
+	template<class QueueDataType>
+	class MPMCQueue
+	{
+	private:
+		struct Cell
+		{
+			std::atomic<size_t> Sequence;										/* == position when free for a producer, == position + 1 when filled */
+			alignas(QueueDataType) unsigned char Storage[sizeof(QueueDataType)];	/* the object, constructed in place */
+
+			inline QueueDataType* Object()
+			{
+				return std::launder(reinterpret_cast<QueueDataType*>(Storage));
+			}
+		};
+
+		alignas(CacheLineSize) Cell* Cells;
+		size_t Mask;											/* capacity - 1, capacity is always a power of 2 */
+		alignas(CacheLineSize) std::atomic<size_t> EnqueuePosition = 0;	/* producers only */
+		alignas(CacheLineSize) std::atomic<size_t> DequeuePosition = 0;	/* consumers only (class alignment pads the end of the line) */
+
+		/// <summary>
+		/// Claims up to maxCount consecutive cells which are in the wanted state
+		/// </summary>
+		/// <param name="position">- atomic position to claim from</param>
+		/// <param name="sequenceOffset">- 0 for producers (cell free), 1 for consumers (cell filled)</param>
+		/// <param name="maxCount">- most cells to claim</param>
+		/// <param name="claimedPosition">- gets set to the first claimed position</param>
+		/// <returns>amount of cells claimed (0 if full/empty)</returns>
+		inline size_t Claim(std::atomic<size_t>& position, const size_t& sequenceOffset, const size_t& maxCount, size_t* claimedPosition)
+		{
+			size_t start = position.load(std::memory_order_relaxed);
+
+			while (true)
+			{
+				size_t count = 0;
+				bool lostRace = false;
+				while (count < maxCount)
+				{
+					size_t sequence = Cells[(start + count) & Mask].Sequence.load(std::memory_order_acquire);
+					intptr_t difference = (intptr_t)sequence - (intptr_t)(start + count + sequenceOffset);
+
+					if (difference != 0)
+					{
+						lostRace = (difference > 0 && count == 0); /* someone else already took the first cell */
+						break;
+					}
+					count++;
+				}
+
+				if (count == 0)
+				{
+					if (!lostRace)
+					{
+						return 0;
+					}
+					start = position.load(std::memory_order_relaxed);
+					continue;
+				}
+
+				/* cells only change state after being claimed through position, so if the CAS works they are all ours */
+				if (position.compare_exchange_weak(start, start + count, std::memory_order_relaxed))
+				{
+					*claimedPosition = start;
+					return count;
+				}
+			}
+		}
+
+	public:
+		/// <summary>
+		/// Constructor
+		/// </summary>
+		/// <param name="capacity">- most objects the queue can hold, gets rounded up to a power of 2 (at least 2)</param>
+		inline MPMCQueue(const size_t& capacity)
+		{
+			size_t roundedCapacity = 2;
+			while (roundedCapacity < capacity)
+			{
+				roundedCapacity <<= 1;
+			}
+
+			Mask = roundedCapacity - 1;
+			Cells = new Cell[roundedCapacity];
+			for (size_t i = 0; i < roundedCapacity; i++)
+			{
+				Cells[i].Sequence.store(i, std::memory_order_relaxed);
+			}
+		}
+
+		MPMCQueue(const MPMCQueue&) = delete;
+		MPMCQueue& operator=(const MPMCQueue&) = delete;
+
+		inline ~MPMCQueue()
+		{
+			if constexpr (!std::is_trivially_destructible_v<QueueDataType>) /* destroy objects nobody popped */
+			{
+				size_t enqueuePosition = EnqueuePosition.load(std::memory_order_relaxed);
+				for (size_t position = DequeuePosition.load(std::memory_order_relaxed); position != enqueuePosition; position++)
+				{
+					Cells[position & Mask].Object()->~QueueDataType();
+				}
+			}
+			delete[] Cells;
+		}
+
+		/// <summary>
+		/// Tries to push object onto the queue
+		/// </summary>
+		/// <param name="object">- object to push (only moved from if it succeeds)</param>
+		/// <returns>false if the queue was full</returns>
+		template<class ObjectType>
+		inline bool TryPush(ObjectType&& object)
+		{
+			size_t position;
+			if (Claim(EnqueuePosition, 0, 1, &position) == 0)
+			{
+				return false;
+			}
+
+			Cell& cell = Cells[position & Mask];
+			new (cell.Storage) QueueDataType(std::forward<ObjectType>(object));
+			cell.Sequence.store(position + 1, std::memory_order_release);
+			return true;
+		}
+
+		/// <summary>
+		/// Tries to pop an object from the queue
+		/// </summary>
+		/// <param name="out">- gets the popped object moved into it</param>
+		/// <returns>false if the queue was empty</returns>
+		inline bool TryPop(QueueDataType& out)
+		{
+			size_t position;
+			if (Claim(DequeuePosition, 1, 1, &position) == 0)
+			{
+				return false;
+			}
+
+			Cell& cell = Cells[position & Mask];
+			out = std::move(*cell.Object());
+			cell.Object()->~QueueDataType();
+			cell.Sequence.store(position + Mask + 1, std::memory_order_release); /* free for the producer one lap ahead */
+			return true;
+		}
+
+		/// <summary>
+		/// Pushes object, spinning (then yielding) while the queue is full
+		/// </summary>
+		/// <param name="object">- object to push</param>
+		template<class ObjectType>
+		inline void Push(ObjectType&& object)
+		{
+			Backoff backoff;
+			while (!TryPush(std::forward<ObjectType>(object))) /* only moved from on success, so forwarding again is fine */
+			{
+				backoff.Pause();
+			}
+		}
+
+		/// <summary>
+		/// Pops an object, spinning (then yielding) while the queue is empty
+		/// </summary>
+		/// <param name="out">- gets the popped object moved into it</param>
+		inline void Pop(QueueDataType& out)
+		{
+			Backoff backoff;
+			while (!TryPop(out))
+			{
+				backoff.Pause();
+			}
+		}
+
+		/// <summary>
+		/// Pushes as many objects as fit with a single claim
+		/// </summary>
+		/// <param name="objects">- objects to push (the pushed ones get moved from)</param>
+		/// <param name="count">- amount of objects</param>
+		/// <returns>amount pushed, the first N of objects</returns>
+		inline size_t TryPushBatch(QueueDataType* objects, const size_t& count)
+		{
+			size_t position;
+			size_t claimed = Claim(EnqueuePosition, 0, count, &position);
+
+			for (size_t i = 0; i < claimed; i++)
+			{
+				Cell& cell = Cells[(position + i) & Mask];
+				new (cell.Storage) QueueDataType(std::move(objects[i]));
+				cell.Sequence.store(position + i + 1, std::memory_order_release);
+			}
+
+			return claimed;
+		}
+
+		/// <summary>
+		/// Pops up to maxCount objects with a single claim
+		/// </summary>
+		/// <param name="out">- array the objects get moved into</param>
+		/// <param name="maxCount">- size of out</param>
+		/// <returns>amount popped</returns>
+		inline size_t TryPopBatch(QueueDataType* out, const size_t& maxCount)
+		{
+			size_t position;
+			size_t claimed = Claim(DequeuePosition, 1, maxCount, &position);
+
+			for (size_t i = 0; i < claimed; i++)
+			{
+				Cell& cell = Cells[(position + i) & Mask];
+				out[i] = std::move(*cell.Object());
+				cell.Object()->~QueueDataType();
+				cell.Sequence.store(position + i + Mask + 1, std::memory_order_release);
+			}
+
+			return claimed;
+		}
+
+		/// <summary>
+		/// Approximate amount of objects in the queue (can be out of date as soon as it returns)
+		/// </summary>
+		/// <returns>approximate size</returns>
+		inline size_t Size() const
+		{
+			size_t enqueuePosition = EnqueuePosition.load(std::memory_order_relaxed);
+			size_t dequeuePosition = DequeuePosition.load(std::memory_order_relaxed);
+			return (enqueuePosition > dequeuePosition ? enqueuePosition - dequeuePosition : 0);
+		}
+
+		/// <summary>
+		/// if the queue is (approximately) empty
+		/// </summary>
+		/// <returns>if the queue is empty</returns>
+		inline bool Empty() const
+		{
+			return Size() == 0;
+		}
+
+		/// <summary>
+		/// most objects the queue can hold
+		/// </summary>
+		/// <returns>capacity</returns>
+		inline size_t Capacity() const
+		{
+			return Mask + 1;
+		}
+	};
+
+	/// <summary>
+	/// Bounded lock free single producer single consumer ring buffer. producer and consumer indexes live on their own cache lines
+	/// and each side caches the other side's index, so the shared lines are only touched when the cached value runs out
+	/// </summary>
+	/// <typeparam name="QueueDataType">- datatype stored in the queue (has to be move constructible)</typeparam>
+	template<class QueueDataType>
+	class SPSCQueue
+	{
+	private:
+		struct Slot
+		{
+			alignas(QueueDataType) unsigned char Storage[sizeof(QueueDataType)];
+
+			inline QueueDataType* Object()
+			{
+				return std::launder(reinterpret_cast<QueueDataType*>(Storage));
+			}
+		};
+
+		alignas(CacheLineSize) Slot* Slots;
+		size_t Mask;											/* capacity - 1, capacity is always a power of 2 */
+
+		alignas(CacheLineSize) std::atomic<size_t> Tail = 0;	/* next position to write, written by the producer */
+		size_t CachedHead = 0;									/* producer's last look at Head */
+
+		alignas(CacheLineSize) std::atomic<size_t> Head = 0;	/* next position to read, written by the consumer */
+		size_t CachedTail = 0;									/* consumer's last look at Tail */
+
+		/// <summary>
+		/// free slots from the producer's view, refreshes CachedHead if it looks full
+		/// </summary>
+		inline size_t FreeSlots(const size_t& tail, const size_t& wanted)
+		{
+			size_t freeSlots = (Mask + 1) - (tail - CachedHead);
+			if (freeSlots < wanted)
+			{
+				CachedHead = Head.load(std::memory_order_acquire);
+				freeSlots = (Mask + 1) - (tail - CachedHead);
+			}
+			return freeSlots;
+		}
+
+		/// <summary>
+		/// filled slots from the consumer's view, refreshes CachedTail if it looks empty
+		/// </summary>
+		inline size_t FilledSlots(const size_t& head, const size_t& wanted)
+		{
+			size_t filledSlots = CachedTail - head;
+			if (filledSlots < wanted)
+			{
+				CachedTail = Tail.load(std::memory_order_acquire);
+				filledSlots = CachedTail - head;
+			}
+			return filledSlots;
+		}
+
+	public:
+		/// <summary>
+		/// Constructor
+		/// </summary>
+		/// <param name="capacity">- most objects the queue can hold, gets rounded up to a power of 2 (at least 2)</param>
+		inline SPSCQueue(const size_t& capacity)
+		{
+			size_t roundedCapacity = 2;
+			while (roundedCapacity < capacity)
+			{
+				roundedCapacity <<= 1;
+			}
+
+			Mask = roundedCapacity - 1;
+			Slots = new Slot[roundedCapacity];
+		}
+
+		SPSCQueue(const SPSCQueue&) = delete;
+		SPSCQueue& operator=(const SPSCQueue&) = delete;
+
+		inline ~SPSCQueue()
+		{
+			if constexpr (!std::is_trivially_destructible_v<QueueDataType>)
+			{
+				size_t tail = Tail.load(std::memory_order_relaxed);
+				for (size_t position = Head.load(std::memory_order_relaxed); position != tail; position++)
+				{
+					Slots[position & Mask].Object()->~QueueDataType();
+				}
+			}
+			delete[] Slots;
+		}
+
+		/// <summary>
+		/// Tries to push object. ONLY the producer thread may call this
+		/// </summary>
+		/// <param name="object">- object to push (only moved from if it succeeds)</param>
+		/// <returns>false if the queue was full</returns>
+		template<class ObjectType>
+		inline bool TryPush(ObjectType&& object)
+		{
+			size_t tail = Tail.load(std::memory_order_relaxed);
+			if (FreeSlots(tail, 1) == 0)
+			{
+				return false;
+			}
+
+			new (Slots[tail & Mask].Storage) QueueDataType(std::forward<ObjectType>(object));
+			Tail.store(tail + 1, std::memory_order_release);
+			return true;
+		}
+
+		/// <summary>
+		/// Tries to pop an object. ONLY the consumer thread may call this
+		/// </summary>
+		/// <param name="out">- gets the popped object moved into it</param>
+		/// <returns>false if the queue was empty</returns>
+		inline bool TryPop(QueueDataType& out)
+		{
+			size_t head = Head.load(std::memory_order_relaxed);
+			if (FilledSlots(head, 1) == 0)
+			{
+				return false;
+			}
+
+			QueueDataType* object = Slots[head & Mask].Object();
+			out = std::move(*object);
+			object->~QueueDataType();
+			Head.store(head + 1, std::memory_order_release);
+			return true;
+		}
+
+		/// <summary>
+		/// Pushes object, spinning (then yielding) while the queue is full. ONLY the producer thread may call this
+		/// </summary>
+		/// <param name="object">- object to push</param>
+		template<class ObjectType>
+		inline void Push(ObjectType&& object)
+		{
+			Backoff backoff;
+			while (!TryPush(std::forward<ObjectType>(object)))
+			{
+				backoff.Pause();
+			}
+		}
+
+		/// <summary>
+		/// Pops an object, spinning (then yielding) while the queue is empty. ONLY the consumer thread may call this
+		/// </summary>
+		/// <param name="out">- gets the popped object moved into it</param>
+		inline void Pop(QueueDataType& out)
+		{
+			Backoff backoff;
+			while (!TryPop(out))
+			{
+				backoff.Pause();
+			}
+		}
+
+		/// <summary>
+		/// Pushes as many objects as fit, publishing them all with one store. ONLY the producer thread may call this
+		/// </summary>
+		/// <param name="objects">- objects to push (the pushed ones get moved from)</param>
+		/// <param name="count">- amount of objects</param>
+		/// <returns>amount pushed, the first N of objects</returns>
+		inline size_t TryPushBatch(QueueDataType* objects, const size_t& count)
+		{
+			size_t tail = Tail.load(std::memory_order_relaxed);
+			size_t freeSlots = FreeSlots(tail, count);
+			size_t pushCount = (count < freeSlots ? count : freeSlots);
+
+			for (size_t i = 0; i < pushCount; i++)
+			{
+				new (Slots[(tail + i) & Mask].Storage) QueueDataType(std::move(objects[i]));
+			}
+
+			Tail.store(tail + pushCount, std::memory_order_release);
+			return pushCount;
+		}
+
+		/// <summary>
+		/// Pops up to maxCount objects, freeing them all with one store. ONLY the consumer thread may call this
+		/// </summary>
+		/// <param name="out">- array the objects get moved into</param>
+		/// <param name="maxCount">- size of out</param>
+		/// <returns>amount popped</returns>
+		inline size_t TryPopBatch(QueueDataType* out, const size_t& maxCount)
+		{
+			size_t head = Head.load(std::memory_order_relaxed);
+			size_t filledSlots = FilledSlots(head, maxCount);
+			size_t popCount = (maxCount < filledSlots ? maxCount : filledSlots);
+
+			for (size_t i = 0; i < popCount; i++)
+			{
+				QueueDataType* object = Slots[(head + i) & Mask].Object();
+				out[i] = std::move(*object);
+				object->~QueueDataType();
+			}
+
+			Head.store(head + popCount, std::memory_order_release);
+			return popCount;
+		}
+
+		/// <summary>
+		/// Approximate amount of objects in the queue (can be out of date as soon as it returns)
+		/// </summary>
+		/// <returns>approximate size</returns>
+		inline size_t Size() const
+		{
+			size_t tail = Tail.load(std::memory_order_acquire);
+			size_t head = Head.load(std::memory_order_acquire);
+			return (tail > head ? tail - head : 0);
+		}
+
+		/// <summary>
+		/// if the queue is (approximately) empty
+		/// </summary>
+		/// <returns>if the queue is empty</returns>
+		inline bool Empty() const
+		{
+			return Size() == 0;
+		}
+
+		/// <summary>
+		/// most objects the queue can hold
+		/// </summary>
+		/// <returns>capacity</returns>
+		inline size_t Capacity() const
+		{
+			return Mask + 1;
+		}
+	};
+}
+
+#endif /* _CONCURRENTQUEUE_NOSLIB_HPP_ */
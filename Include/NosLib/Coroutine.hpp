@@ -0,0 +1,595 @@
+#ifndef _COROUTINE_NOSLIB_HPP_
+#define _COROUTINE_NOSLIB_HPP_
+
+#include "ThreadPool.hpp"
+
+#include <coroutine>
+#include <optional>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace NosLib
+{
+	template<typename ResultType = void>
+	class Task;
+
+	/// <summary>
+	/// namespace which contains the machinery behind NosLib::Task (promises, awaiters and drivers)
+	/// </summary>
+	namespace Coroutine
+	{
+		/// <summary>
+		/// final awaiter of a Task, resumes whoever was awaiting it through symmetric transfer (no stack growth)
+		/// </summary>
+		struct FinalAwaiter
+		{
+			inline bool await_ready() const noexcept { return false; }
+
+			template<class PromiseType>
+			inline std::coroutine_handle<> await_suspend(std::coroutine_handle<PromiseType> finishedHandle) const noexcept
+			{
+				std::coroutine_handle<> continuation = finishedHandle.promise().Continuation;
+				return (continuation ? continuation : std::noop_coroutine());
+			}
+
+			inline void await_resume() const noexcept {}
+		};
+
+		/// <summary>
+		/// parts of the promise which don't depend on the result type
+		/// </summary>
+		class PromiseBase
+		{
+		public:
+			std::coroutine_handle<> Continuation;	/* coroutine awaiting this one */
+			std::exception_ptr Exception;			/* exception which escaped the coroutine body */
+
+			inline std::suspend_always initial_suspend() const noexcept { return {}; } /* tasks are lazy, they start once awaited */
+			inline FinalAwaiter final_suspend() const noexcept { return {}; }
+
+			inline void unhandled_exception() noexcept
+			{
+				Exception = std::current_exception();
+			}
+		};
+
+		template<typename ResultType>
+		class Promise : public PromiseBase
+		{
+		public:
+			std::optional<ResultType> Value;
+
+			inline Task<ResultType> get_return_object() noexcept;
+
+			template<typename ValueType>
+			inline void return_value(ValueType&& value)
+			{
+				Value.emplace(std::forward<ValueType>(value));
+			}
+
+			inline ResultType TakeResult()
+			{
+				if (Exception)
+				{
+					std::rethrow_exception(Exception);
+				}
+
+				return std::move(*Value);
+			}
+		};
+
+		template<>
+		class Promise<void> : public PromiseBase
+		{
+		public:
+			inline Task<void> get_return_object() noexcept;
+
+			inline void return_void() noexcept {}
+
+			inline void TakeResult()
+			{
+				if (Exception)
+				{
+					std::rethrow_exception(Exception);
+				}
+			}
+		};
+
+		/// <summary>
+		/// eager self destroying coroutine used internally to drive Tasks. the value it co_returns is the coroutine to transfer to once it finishes
+		/// </summary>
+		class DriverTask
+		{
+		public:
+			class promise_type
+			{
+			public:
+				std::coroutine_handle<> Next; /* coroutine to resume once the driver is done (can be empty) */
+
+				struct FinalTransfer
+				{
+					inline bool await_ready() const noexcept { return false; }
+
+					inline std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> finishedHandle) const noexcept
+					{
+						std::coroutine_handle<> next = finishedHandle.promise().Next;
+						finishedHandle.destroy(); /* nothing owns a started driver, so it cleans up after itself */
+						return (next ? next : std::noop_coroutine());
+					}
+
+					inline void await_resume() const noexcept {}
+				};
+
+				inline DriverTask get_return_object() noexcept
+				{
+					return DriverTask(std::coroutine_handle<promise_type>::from_promise(*this));
+				}
+
+				inline std::suspend_always initial_suspend() const noexcept { return {}; }
+				inline FinalTransfer final_suspend() const noexcept { return {}; }
+
+				inline void return_value(const std::coroutine_handle<>& next) noexcept
+				{
+					Next = next;
+				}
+
+				inline void unhandled_exception() noexcept
+				{
+					std::terminate(); /* drivers catch everything themselves */
+				}
+			};
+
+		protected:
+			std::coroutine_handle<promise_type> Handle;
+
+		public:
+			inline explicit DriverTask(std::coroutine_handle<promise_type> handle) : Handle(handle) {}
+
+			inline DriverTask(DriverTask&& other) noexcept : Handle(std::exchange(other.Handle, nullptr)) {}
+
+			DriverTask(const DriverTask&) = delete;
+			DriverTask& operator=(const DriverTask&) = delete;
+
+			inline ~DriverTask()
+			{
+				if (Handle) /* never started */
+				{
+					Handle.destroy();
+				}
+			}
+
+			/// <summary>
+			/// Starts the driver, after this it owns itself
+			/// </summary>
+			inline void Start()
+			{
+				std::exchange(Handle, nullptr).resume();
+			}
+		};
+
+		/// <summary>
+		/// Awaitable which moves the awaiting coroutine onto a ThreadPool worker
+		/// </summary>
+		class ScheduleAwaitable
+		{
+		protected:
+			NosLib::ThreadPool* Pool;
+			NosLib::ThreadPool::Priority TaskPriority;
+
+		public:
+			inline ScheduleAwaitable(NosLib::ThreadPool* pool, const NosLib::ThreadPool::Priority& priority)
+			{
+				Pool = pool;
+				TaskPriority = priority;
+			}
+
+			inline bool await_ready() const noexcept { return false; }
+
+			inline void await_suspend(std::coroutine_handle<> awaitingHandle) const
+			{
+				Pool->Submit([awaitingHandle]() { awaitingHandle.resume(); }, TaskPriority);
+			}
+
+			inline void await_resume() const noexcept {}
+		};
+
+		/// <summary>
+		/// state shared between WhenAll/WhenAny and the drivers running each child
+		/// </summary>
+		struct CombinatorState
+		{
+			std::atomic<size_t> Remaining = 0;			/* WhenAll: children left + 1 for the launcher */
+			std::atomic<bool> Finished = false;			/* WhenAny: set by the first child to finish */
+			std::coroutine_handle<> Parent;				/* the WhenAll/WhenAny coroutine */
+			std::mutex ExceptionMutex;
+			std::exception_ptr Exception;				/* first exception thrown by a child */
+
+			inline void SetException(const std::exception_ptr& exception)
+			{
+				std::lock_guard<std::mutex> lock(ExceptionMutex);
+				if (!Exception)
+				{
+					Exception = exception;
+				}
+			}
+		};
+
+		template<typename ResultType>
+		using ResultSlot = std::optional<std::conditional_t<std::is_void_v<ResultType>, bool, ResultType>>;
+
+		template<typename ResultType>
+		inline DriverTask WhenAllDriver(Task<ResultType>& child, ResultSlot<ResultType>& slot, CombinatorState& state)
+		{
+			try
+			{
+				if constexpr (std::is_void_v<ResultType>)
+				{
+					co_await child;
+					slot.emplace(true);
+				}
+				else
+				{
+					slot.emplace(co_await child);
+				}
+			}
+			catch (...)
+			{
+				state.SetException(std::current_exception());
+			}
+
+			/* last one out resumes the parent */
+			co_return (state.Remaining.fetch_sub(1) == 1 ? state.Parent : std::coroutine_handle<>());
+		}
+
+		template<typename ResultType>
+		inline DriverTask WhenAnyDriver(std::shared_ptr<std::vector<Task<ResultType>>> children, size_t index, std::shared_ptr<CombinatorState> state, std::shared_ptr<std::pair<size_t, ResultSlot<ResultType>>> winner)
+		{
+			ResultSlot<ResultType> result;
+			std::exception_ptr exception;
+
+			try
+			{
+				if constexpr (std::is_void_v<ResultType>)
+				{
+					co_await (*children)[index];
+					result.emplace(true);
+				}
+				else
+				{
+					result.emplace(co_await (*children)[index]);
+				}
+			}
+			catch (...)
+			{
+				exception = std::current_exception();
+			}
+
+			if (state->Finished.exchange(true)) /* someone already won */
+			{
+				co_return std::coroutine_handle<>();
+			}
+
+			winner->first = index;
+			winner->second = std::move(result);
+			if (exception)
+			{
+				state->SetException(exception);
+			}
+			co_return state->Parent;
+		}
+
+		template<typename ResultType>
+		class WhenAllAwaitable
+		{
+		protected:
+			std::vector<Task<ResultType>>& Children;
+			std::vector<ResultSlot<ResultType>>& Slots;
+			CombinatorState& State;
+
+		public:
+			inline WhenAllAwaitable(std::vector<Task<ResultType>>& children, std::vector<ResultSlot<ResultType>>& slots, CombinatorState& state) : Children(children), Slots(slots), State(state) {}
+
+			inline bool await_ready() const noexcept { return Children.empty(); }
+
+			inline bool await_suspend(std::coroutine_handle<> parentHandle)
+			{
+				State.Parent = parentHandle;
+				State.Remaining.store(Children.size() + 1); /* +1 so children finishing inline can't resume the parent while still launching */
+
+				for (size_t i = 0; i < Children.size(); i++)
+				{
+					WhenAllDriver<ResultType>(Children[i], Slots[i], State).Start();
+				}
+
+				return State.Remaining.fetch_sub(1) != 1; /* false resumes the parent straight away */
+			}
+
+			inline void await_resume() const noexcept {}
+		};
+
+		template<typename ResultType>
+		class WhenAnyAwaitable
+		{
+		protected:
+			std::shared_ptr<std::vector<Task<ResultType>>> Children;
+			std::shared_ptr<CombinatorState> State;
+			std::shared_ptr<std::pair<size_t, ResultSlot<ResultType>>> Winner;
+
+		public:
+			inline WhenAnyAwaitable(std::shared_ptr<std::vector<Task<ResultType>>> children, std::shared_ptr<CombinatorState> state, std::shared_ptr<std::pair<size_t, ResultSlot<ResultType>>> winner) :
+				Children(children), State(state), Winner(winner) {}
+
+			inline bool await_ready() const noexcept { return false; }
+
+			inline void await_suspend(std::coroutine_handle<> parentHandle)
+			{
+				State->Parent = parentHandle;
+
+				/* the first child to finish resumes the parent, possibly inline during this loop.
+				   copies of the shared pointers are taken first since this awaitable can be destroyed once the parent resumes */
+				std::shared_ptr<std::vector<Task<ResultType>>> children = Children;
+				std::shared_ptr<CombinatorState> state = State;
+				std::shared_ptr<std::pair<size_t, ResultSlot<ResultType>>> winner = Winner;
+
+				for (size_t i = 0; i < children->size() && !state->Finished.load(); i++)
+				{
+					WhenAnyDriver<ResultType>(children, i, state, winner).Start();
+				}
+			}
+
+			inline void await_resume() const noexcept {}
+		};
+
+		struct SyncWaitState
+		{
+			std::mutex Mutex;
+			std::condition_variable CV;
+			bool Done = false;
+		};
+
+		template<typename ResultType>
+		inline DriverTask SyncWaitDriver(Task<ResultType>& task, SyncWaitState& state)
+		{
+			try
+			{
+				co_await task;
+			}
+			catch (...) {} /* stays stored inside the task's promise, SyncWait rethrows it */
+
+			/* notify under the lock, the waiting thread destroys state as soon as it can take the lock */
+			std::lock_guard<std::mutex> lock(state.Mutex);
+			state.Done = true;
+			state.CV.notify_all();
+			co_return std::coroutine_handle<>();
+		}
+	}
+
+	/// <summary>
+	/// lazy coroutine which produces ResultType. starts running once awaited (or passed to SyncWait),
+	/// resumes its awaiter through symmetric transfer once done. use co_await NosLib::ScheduleOn(pool) to move onto a ThreadPool worker
+	/// </summary>
+	/// <typeparam name="ResultType">- type the coroutine co_returns</typeparam>
+	template<typename ResultType>
+	class Task
+	{
+	public:
+		using promise_type = NosLib::Coroutine::Promise<ResultType>;
+
+	protected:
+		std::coroutine_handle<promise_type> Handle;
+
+	public:
+		inline Task() noexcept : Handle(nullptr) {}
+
+		inline explicit Task(std::coroutine_handle<promise_type> handle) noexcept : Handle(handle) {}
+
+		inline Task(Task&& other) noexcept : Handle(std::exchange(other.Handle, nullptr)) {}
+
+		inline Task& operator=(Task&& other) noexcept
+		{
+			if (this != &other)
+			{
+				if (Handle)
+				{
+					Handle.destroy();
+				}
+				Handle = std::exchange(other.Handle, nullptr);
+			}
+			return *this;
+		}
+
+		Task(const Task&) = delete;
+		Task& operator=(const Task&) = delete;
+
+		inline ~Task()
+		{
+			if (Handle)
+			{
+				Handle.destroy();
+			}
+		}
+
+		/// <summary>
+		/// if the coroutine has finished
+		/// </summary>
+		/// <returns>if it is done</returns>
+		inline bool IsDone() const
+		{
+			return !Handle || Handle.done();
+		}
+
+		/// <summary>
+		/// Takes the result of a finished task (rethrows if the coroutine threw)
+		/// </summary>
+		/// <returns>the result</returns>
+		inline ResultType GetResult()
+		{
+			return Handle.promise().TakeResult();
+		}
+
+		inline auto operator co_await() noexcept
+		{
+			struct TaskAwaiter
+			{
+				std::coroutine_handle<promise_type> Handle;
+
+				inline bool await_ready() const noexcept
+				{
+					return !Handle || Handle.done();
+				}
+
+				inline std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaitingHandle) noexcept
+				{
+					Handle.promise().Continuation = awaitingHandle;
+					return Handle; /* symmetric transfer, starts the task without growing the stack */
+				}
+
+				inline ResultType await_resume()
+				{
+					return Handle.promise().TakeResult();
+				}
+			};
+
+			return TaskAwaiter{ Handle };
+		}
+	};
+
+	template<typename ResultType>
+	inline Task<ResultType> NosLib::Coroutine::Promise<ResultType>::get_return_object() noexcept
+	{
+		return Task<ResultType>(std::coroutine_handle<Promise<ResultType>>::from_promise(*this));
+	}
+
+	inline Task<void> NosLib::Coroutine::Promise<void>::get_return_object() noexcept
+	{
+		return Task<void>(std::coroutine_handle<Promise<void>>::from_promise(*this));
+	}
+
+	/// <summary>
+	/// Awaitable which continues the coroutine on one of the pool's workers. co_await NosLib::ScheduleOn(pool)
+	/// </summary>
+	/// <param name="pool">- pool to continue on (StartWorkers has to be called first)</param>
+	/// <param name="priority">(default = Priority::Normal) - priority of the continuation</param>
+	/// <returns>awaitable</returns>
+	inline NosLib::Coroutine::ScheduleAwaitable ScheduleOn(NosLib::ThreadPool& pool, const NosLib::ThreadPool::Priority& priority = NosLib::ThreadPool::Priority::Normal)
+	{
+		return NosLib::Coroutine::ScheduleAwaitable(&pool, priority);
+	}
+
+	/// <summary>
+	/// Runs the task and blocks the calling thread until it finishes. the bridge between normal code and coroutines
+	/// (don't call it from a worker of a pool the task needs, use co_await there)
+	/// </summary>
+	/// <typeparam name="ResultType">- task result type</typeparam>
+	/// <param name="task">- task to run</param>
+	/// <returns>the task's result (rethrows if the task threw)</returns>
+	template<typename ResultType>
+	inline ResultType SyncWait(Task<ResultType>&& task)
+	{
+		NosLib::Coroutine::SyncWaitState state;
+		NosLib::Coroutine::SyncWaitDriver<ResultType>(task, state).Start();
+
+		{
+			std::unique_lock<std::mutex> lock(state.Mutex);
+			state.CV.wait(lock, [&state]() { return state.Done; });
+		}
+
+		return task.GetResult();
+	}
+
+	/// <summary>
+	/// Runs all tasks concurrently and finishes once every one of them has. the tasks should schedule themselves onto a pool to actually run in parallel
+	/// </summary>
+	/// <typeparam name="ResultType">- result type of the tasks</typeparam>
+	/// <param name="tasks">- tasks to run</param>
+	/// <returns>task producing the results in the same order as tasks (rethrows the first exception)</returns>
+	template<typename ResultType>
+	inline Task<std::vector<ResultType>> WhenAll(std::vector<Task<ResultType>> tasks)
+	{
+		std::vector<NosLib::Coroutine::ResultSlot<ResultType>> slots(tasks.size());
+		NosLib::Coroutine::CombinatorState state;
+
+		co_await NosLib::Coroutine::WhenAllAwaitable<ResultType>(tasks, slots, state);
+
+		if (state.Exception)
+		{
+			std::rethrow_exception(state.Exception);
+		}
+
+		std::vector<ResultType> results;
+		results.reserve(slots.size());
+		for (NosLib::Coroutine::ResultSlot<ResultType>& slot : slots)
+		{
+			results.push_back(std::move(*slot));
+		}
+		co_return results;
+	}
+
+	/// <summary>
+	/// Runs all void tasks concurrently and finishes once every one of them has
+	/// </summary>
+	/// <param name="tasks">- tasks to run</param>
+	/// <returns>task which finishes when all of them did (rethrows the first exception)</returns>
+	inline Task<void> WhenAll(std::vector<Task<void>> tasks)
+	{
+		std::vector<NosLib::Coroutine::ResultSlot<void>> slots(tasks.size());
+		NosLib::Coroutine::CombinatorState state;
+
+		co_await NosLib::Coroutine::WhenAllAwaitable<void>(tasks, slots, state);
+
+		if (state.Exception)
+		{
+			std::rethrow_exception(state.Exception);
+		}
+	}
+
+	/// <summary>
+	/// result of WhenAny
+	/// </summary>
+	template<typename ResultType>
+	struct WhenAnyResult
+	{
+		size_t Index;		/* which task finished first */
+		ResultType Value;	/* its result */
+	};
+
+	/// <summary>
+	/// Runs all tasks concurrently and finishes as soon as the first one does. the rest keep running in the background until they finish
+	/// </summary>
+	/// <typeparam name="ResultType">- result type of the tasks (not void)</typeparam>
+	/// <param name="tasks">- tasks to run (must not be empty)</param>
+	/// <returns>task producing the index and result of the first task to finish (rethrows if that task threw)</returns>
+	template<typename ResultType>
+	inline Task<WhenAnyResult<ResultType>> WhenAny(std::vector<Task<ResultType>> tasks)
+	{
+		static_assert(!std::is_void_v<ResultType>, "WhenAny needs a result type");
+
+		if (tasks.empty())
+		{
+			throw std::invalid_argument("WhenAny needs at least one task");
+		}
+
+		/* shared, the tasks still running after the winner need everything to stay alive */
+		auto children = std::make_shared<std::vector<Task<ResultType>>>(std::move(tasks));
+		auto state = std::make_shared<NosLib::Coroutine::CombinatorState>();
+		auto winner = std::make_shared<std::pair<size_t, NosLib::Coroutine::ResultSlot<ResultType>>>();
+
+		co_await NosLib::Coroutine::WhenAnyAwaitable<ResultType>(children, state, winner);
+
+		if (state->Exception)
+		{
+			std::rethrow_exception(state->Exception);
+		}
+
+		co_return WhenAnyResult<ResultType>{ winner->first, std::move(*winner->second) };
+	}
+}
+
+#endif /* _COROUTINE_NOSLIB_HPP_ */
@@ -16,12 +16,6 @@ namespace NosLib
 	/// </summary>
 	namespace TestEnv
 	{
-		/*[coroutine] TODO: research, test and implement coroutines
-		int CoroutineTest()
-		{
-
-		}*/
-
 		namespace PointerRoots
 		{
 			template<typename T>
@@ -3,6 +3,7 @@
 
 #include "Logging.hpp"
 #include "String.hpp"
+#include "String/StringBuilder.hpp"
 #include "HostPath.hpp"
 
 #include <httplib.h>
@@ -85,40 +86,41 @@ namespace NosLib
 	protected:
 		inline static void LoggingFunction(const httplib::Request& req, const httplib::Response& res)
 		{
-			/* if is more then Debug */
-			if (NosLib::Logging::GetVerboseLevel() > Logging::Verbose::Debug)
+			/* building the message is expensive, skip it unless Debug logs get through */
+			if (!NosLib::Logging::IsEnabled(NosLib::Logging::Severity::Debug))
 			{
 				return;
 			}
 
-			std::string logOutput;
-			logOutput += ("====================================================================================================================\nRequest\n");
-			logOutput += (std::format(":METHOD: {}\n", req.method).c_str());
-			logOutput += (std::format(":PATH:   {}\n", req.path).c_str());
-			logOutput += (std::format(":BODY:   {}\n", req.body).c_str());
+			/* sized for the bodies up front, everything gets formatted straight into the builder */
+			NosLib::String::StringBuilder<char> logOutput(req.body.size() + res.body.size() + 1024);
+			logOutput.Append("====================================================================================================================\nRequest\n");
+			logOutput.Format(":METHOD: {}\n", req.method);
+			logOutput.Format(":PATH:   {}\n", req.path);
+			logOutput.Format(":BODY:   {}\n", req.body);
 
-			logOutput += ("======HEADERS======\n");
+			logOutput.Append("======HEADERS======\n");
 
 			for (auto itr = req.headers.begin(); itr != req.headers.end(); itr++)
 			{
-				logOutput += (std::format("{} : {}\n", itr->first, itr->second).c_str());
+				logOutput.AppendAll(itr->first, " : ", itr->second, '\n');
 			}
-			logOutput += ("====================================================================================================================\nResponse\n");
+			logOutput.Append("====================================================================================================================\nResponse\n");
 
-			logOutput += (std::format(":STATUS: {}\n", res.status).c_str());
-			logOutput += (std::format(":REASON: {}\n", res.reason).c_str());
-			logOutput += (std::format(":BODY:   {}\n", res.body).c_str());
-			logOutput += (std::format(":LOCATION:   {}\n", res.location).c_str());
+			logOutput.Format(":STATUS: {}\n", res.status);
+			logOutput.Format(":REASON: {}\n", res.reason);
+			logOutput.Format(":BODY:   {}\n", res.body);
+			logOutput.Format(":LOCATION:   {}\n", res.location);
 
-			logOutput += ("======HEADERS======\n");
+			logOutput.Append("======HEADERS======\n");
 
 			for (auto itr = res.headers.begin(); itr != res.headers.end(); itr++)
 			{
-				logOutput += (std::format("{} : {}\n", itr->first, itr->second).c_str());
+				logOutput.AppendAll(itr->first, " : ", itr->second, '\n');
 			}
-			logOutput += ("====================================================================================================================\n\n\n");
+			logOutput.Append("====================================================================================================================\n\n\n");
 
-			NosLib::Logging::CreateLog<char>(logOutput, NosLib::Logging::Severity::Debug);
+			NosLib::Logging::CreateLog<char>(logOutput.ToString(), NosLib::Logging::Severity::Debug);
 		}
 	};
 }
@@ -1,13 +1,105 @@
 #ifndef _LOGGING_NOSLIB_HPP_
 #define _LOGGING_NOSLIB_HPP_
 
-#include "DynamicArray.hpp"
 #include "String.hpp"
+#include "ConcurrentQueue.hpp"
+#include "Logging/BinaryLog.hpp"
+#include "Logging/Sinks.hpp"
+#include "Logging/RateLimit.hpp"
 
 #include <fstream>
 #include <chrono>
 #include <string>
 #include <format>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+#include <cstdio>
+#include <stdexcept>
+#include <vector>
+#include <algorithm>
+#include <ostream>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+/* logs below this severity (0 = Debug ... 4 = Fatal) get compiled out of NOSLIB_LOG calls, define it before including to change it */
+#ifndef NOSLIB_LOG_MIN_SEVERITY
+#define NOSLIB_LOG_MIN_SEVERITY 0
+#endif
+
+/* Logs through NosLib::Logging::Log, the arguments only get evaluated and formatted if the severity is enabled.
+ * NOSLIB_LOG(NosLib::Logging::Severity::Debug, "Worker {} started", index) */
+#define NOSLIB_LOG(severity, ...) \
+	do \
+	{ \
+		if constexpr ((int)(severity) >= NosLib::Logging::MinSeverity) \
+		{ \
+			if (NosLib::Logging::IsEnabled(severity)) \
+			{ \
+				NosLib::Logging::Log(severity, __VA_ARGS__); \
+			} \
+		} \
+	} while (false)
+
+#define NOSLIB_LOG_DEBUG(...) NOSLIB_LOG(NosLib::Logging::Severity::Debug, __VA_ARGS__)
+#define NOSLIB_LOG_INFO(...) NOSLIB_LOG(NosLib::Logging::Severity::Info, __VA_ARGS__)
+#define NOSLIB_LOG_WARNING(...) NOSLIB_LOG(NosLib::Logging::Severity::Warning, __VA_ARGS__)
+#define NOSLIB_LOG_ERROR(...) NOSLIB_LOG(NosLib::Logging::Severity::Error, __VA_ARGS__)
+#define NOSLIB_LOG_FATAL(...) NOSLIB_LOG(NosLib::Logging::Severity::Fatal, __VA_ARGS__)
+
+/* Logs through NosLib::Logging::LogBinary, only the format id, a timestamp and the raw arguments get recorded, formatting happens later.
+ * NOSLIB_LOG_BINARY(NosLib::Logging::Severity::Info, "Request {} took {}ns", id, elapsed) */
+#define NOSLIB_LOG_BINARY(severity, ...) \
+	do \
+	{ \
+		if constexpr ((int)(severity) >= NosLib::Logging::MinSeverity) \
+		{ \
+			if (NosLib::Logging::IsEnabled(severity)) \
+			{ \
+				static NosLib::BinaryLog::CallSite noslibBinaryLogSite; \
+				NosLib::Logging::LogBinary(severity, noslibBinaryLogSite, __VA_ARGS__); \
+			} \
+		} \
+	} while (false)
+
+/* Logs at most perSecond times a second (after an initial burst) from this call site, the rest get counted and reported as "suppressed N messages".
+ * NOSLIB_LOG_RATE_LIMITED(NosLib::Logging::Severity::Error, 10, 5, "Read failed: {}", error) */
+#define NOSLIB_LOG_RATE_LIMITED(severity, perSecond, burst, ...) \
+	do \
+	{ \
+		if constexpr ((int)(severity) >= NosLib::Logging::MinSeverity) \
+		{ \
+			if (NosLib::Logging::IsEnabled(severity)) \
+			{ \
+				static NosLib::LogRateLimiter noslibLogLimiter(__FILE__, __LINE__, (uint8_t)(severity), perSecond, burst); \
+				if (noslibLogLimiter.TryAcquire()) \
+				{ \
+					NosLib::Logging::LogLimited(severity, noslibLogLimiter, __VA_ARGS__); \
+				} \
+			} \
+		} \
+	} while (false)
+
+/* Logs a random fraction (probability between 0 and 1) of the logs from this call site, the rest get counted and reported as "suppressed N messages".
+ * NOSLIB_LOG_SAMPLED(NosLib::Logging::Severity::Debug, 0.01, "Packet {} parsed", id) */
+#define NOSLIB_LOG_SAMPLED(severity, probability, ...) \
+	do \
+	{ \
+		if constexpr ((int)(severity) >= NosLib::Logging::MinSeverity) \
+		{ \
+			if (NosLib::Logging::IsEnabled(severity)) \
+			{ \
+				static NosLib::LogSampler noslibLogSampler(__FILE__, __LINE__, (uint8_t)(severity), probability); \
+				if (noslibLogSampler.ShouldLog()) \
+				{ \
+					NosLib::Logging::LogLimited(severity, noslibLogSampler, __VA_ARGS__); \
+				} \
+			} \
+		} \
+	} while (false)
 
 namespace NosLib
 {
@@ -33,83 +125,932 @@ namespace NosLib
 			Fatal,
 			None
 		};
+
+		/* compile time minimum severity, from NOSLIB_LOG_MIN_SEVERITY */
+		static constexpr int MinSeverity = NOSLIB_LOG_MIN_SEVERITY;
+
+		/// <summary>
+		/// what async logging does when the writer can't keep up and a thread's buffer is full
+		/// </summary>
+		enum class OverflowPolicy : uint8_t
+		{
+			Block,		/* caller waits for space, nothing gets lost */
+			Drop,		/* log gets thrown away and counted, caller never waits */
+		};
+
 	protected:
-		static inline NosLib::DynamicArray<Logging*> Logs;
-		static inline Verbose VerboseLevel = Verbose::Warning;
+		/// <summary>
+		/// log line waiting in a thread's staging buffer, Sequence puts it back in order against other threads
+		/// </summary>
+		struct StagedLine
+		{
+			uint64_t Sequence = 0;
+			std::string Line;		/* UTF-8 */
+		};
+
+		/// <summary>
+		/// staging buffers of one logging thread. the thread is the only producer and the writer the only consumer,
+		/// so logging threads never touch the same cache lines
+		/// </summary>
+		class ThreadBuffer
+		{
+		public:
+			NosLib::SPSCQueue<StagedLine> Lines;				/* formatted lines waiting to be written */
+			NosLib::SPSCQueue<BinaryLog::Record> Records;		/* binary records waiting to be formatted or written */
+
+			std::atomic<uint64_t> EnqueuedCount = 0;			/* logs put into the buffers, only the owning thread writes it */
+			std::atomic<uint64_t> FlushedCount = 0;				/* logs written and flushed, only the writer writes it */
+			uint64_t PoppedCount = 0;							/* logs taken out by the writer, writer only */
+			std::atomic<bool> Abandoned = false;				/* owning thread exited (or moved on to a newer writer) */
+
+			inline ThreadBuffer(const size_t& capacity)
+				: Lines(capacity), Records(capacity) {}
+
+			inline bool Empty() const
+			{
+				return Lines.Empty() && Records.Empty();
+			}
+		};
+
+		/// <summary>
+		/// background thread which takes finished log lines and binary records from per thread staging buffers and writes them out in batches,
+		/// handing them to the sinks. binary records get formatted here, or written raw to a binary log file if there is one
+		/// </summary>
+		class AsyncWriter
+		{
+		public:
+			static constexpr size_t BatchSize = 64;				/* most logs taken out of one thread's buffer at once */
+			static constexpr std::chrono::seconds SummaryInterval{1};	/* how often suppressed counts of rate limited sites get reported */
+
+			static inline std::atomic<uint64_t> NextGeneration = 1;	/* tells thread local buffers of an old writer apart from the current one */
+
+			/* the calling thread's staging buffer */
+			struct LocalBuffer
+			{
+				std::shared_ptr<ThreadBuffer> Buffer;
+				uint64_t Generation;
+
+				inline LocalBuffer()
+					: Generation(0) {}
+
+				inline ~LocalBuffer()
+				{
+					if (Buffer != nullptr)
+					{
+						Buffer->Abandoned.store(true, std::memory_order_release);
+					}
+				}
+			};
+
+			static inline thread_local LocalBuffer Local;
+
+			std::mutex BuffersMutex;							/* protects Buffers */
+			std::vector<std::shared_ptr<ThreadBuffer>> Buffers;	/* every thread which logged since the writer started */
+			size_t BufferCapacity;								/* size of each thread's buffers */
+			uint64_t Generation = NextGeneration.fetch_add(1);
+			std::string BinaryLogPath;							/* binary records get written raw here instead of formatted (empty = format them) */
+			OverflowPolicy Policy;
+			std::chrono::steady_clock::duration FlushInterval;	/* longest a written line can sit in the file buffer */
+
+			std::atomic<uint64_t> DroppedCount = 0;				/* logs thrown away by OverflowPolicy::Drop */
+
+			std::mutex WriterMutex;								/* protects the flags below and both CVs */
+			std::condition_variable WakeCV;						/* wakes the writer early */
+			std::condition_variable FlushedCV;					/* wakes Flush callers */
+			bool StopRequested = false;
+			bool FlushRequested = false;
+			std::thread Thread;
+
+			std::chrono::system_clock::time_point SystemAnchor = std::chrono::system_clock::now();	/* turns binary record timestamps into wall time */
+			int64_t SteadyAnchor = BinaryLog::Now();
+
+			inline AsyncWriter(const size_t& bufferCapacity, const OverflowPolicy& policy, const std::chrono::steady_clock::duration& flushInterval, const std::string& binaryLogPath)
+				: BufferCapacity(bufferCapacity), BinaryLogPath(binaryLogPath), Policy(policy), FlushInterval(flushInterval)
+			{
+				Thread = std::thread(&AsyncWriter::WriterLoop, this);
+			}
+
+			AsyncWriter(const AsyncWriter&) = delete;
+			AsyncWriter& operator=(const AsyncWriter&) = delete;
+
+			/* writes out everything left in the buffers and stops the thread */
+			inline ~AsyncWriter()
+			{
+				{
+					std::lock_guard<std::mutex> lock(WriterMutex);
+					StopRequested = true;
+				}
+				WakeCV.notify_one();
+				Thread.join();
+			}
+
+			inline void Wake()
+			{
+				{ std::lock_guard<std::mutex> lock(WriterMutex); }
+				WakeCV.notify_one();
+			}
+
+			/// <summary>
+			/// the calling thread's staging buffer, registering a new one on its first log
+			/// </summary>
+			inline ThreadBuffer& GetLocalBuffer()
+			{
+				if (Local.Generation != Generation)
+				{
+					if (Local.Buffer != nullptr)
+					{
+						Local.Buffer->Abandoned.store(true, std::memory_order_release);
+					}
+
+					Local.Buffer = std::make_shared<ThreadBuffer>(BufferCapacity);
+					Local.Generation = Generation;
+
+					std::lock_guard<std::mutex> lock(BuffersMutex);
+					Buffers.push_back(Local.Buffer);
+				}
+
+				return *Local.Buffer;
+			}
+
+			/// <summary>
+			/// Stages an item in the calling thread's buffer, following Policy if it's full
+			/// </summary>
+			template<typename ItemType>
+			inline void EnqueueTo(ThreadBuffer& buffer, NosLib::SPSCQueue<ItemType>& queue, ItemType&& item)
+			{
+				if (!queue.TryPush(std::move(item)))
+				{
+					if (Policy == OverflowPolicy::Drop)
+					{
+						DroppedCount.fetch_add(1, std::memory_order_relaxed);
+						return;
+					}
+
+					Wake(); /* buffer full, the writer might be sleeping out its interval */
+					queue.Push(std::move(item));
+				}
+
+				buffer.EnqueuedCount.store(buffer.EnqueuedCount.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+				if (queue.Size() > queue.Capacity() / 2) /* getting full, don't wait for the interval */
+				{
+					Wake();
+				}
+			}
+
+			/// <summary>
+			/// Queues a line, following Policy if the calling thread's buffer is full
+			/// </summary>
+			/// <param name="line">- formatted log line</param>
+			/// <param name="sequence">- the log's sequence number</param>
+			inline void Enqueue(std::string&& line, const uint64_t& sequence)
+			{
+				ThreadBuffer& buffer = GetLocalBuffer();
+				EnqueueTo(buffer, buffer.Lines, StagedLine{sequence, std::move(line)});
+			}
+
+			/// <summary>
+			/// Queues a binary record, following Policy if the calling thread's buffer is full
+			/// </summary>
+			/// <param name="record">- the record</param>
+			inline void Enqueue(BinaryLog::Record&& record)
+			{
+				ThreadBuffer& buffer = GetLocalBuffer();
+				EnqueueTo(buffer, buffer.Records, std::move(record));
+			}
+
+			/// <summary>
+			/// Waits until every log queued before the call (by any thread) is written and flushed
+			/// </summary>
+			inline void Flush()
+			{
+				std::vector<std::pair<std::shared_ptr<ThreadBuffer>, uint64_t>> targets;
+				{
+					std::lock_guard<std::mutex> lock(BuffersMutex);
+					for (const std::shared_ptr<ThreadBuffer>& buffer : Buffers)
+					{
+						targets.emplace_back(buffer, buffer->EnqueuedCount.load(std::memory_order_acquire));
+					}
+				}
+
+				std::unique_lock<std::mutex> lock(WriterMutex);
+				FlushRequested = true;
+				WakeCV.notify_one();
+				FlushedCV.wait(lock, [&targets]()
+				{
+					for (const auto& [buffer, target] : targets)
+					{
+						if (buffer->FlushedCount.load() < target)
+						{
+							return false;
+						}
+					}
+					return true;
+				});
+			}
+
+			inline bool BuffersEmpty()
+			{
+				std::lock_guard<std::mutex> lock(BuffersMutex);
+				for (const std::shared_ptr<ThreadBuffer>& buffer : Buffers)
+				{
+					if (!buffer->Empty())
+					{
+						return false;
+					}
+				}
+				return true;
+			}
+
+
+			inline void WriterLoop()
+			{
+				std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+				std::vector<StagedLine> lines;
+				std::vector<BinaryLog::Record> records;
+				bool unflushed = false;
+				std::chrono::steady_clock::time_point lastFlush = std::chrono::steady_clock::now();
+				std::chrono::steady_clock::time_point lastSummary = lastFlush;
+
+				std::ofstream binaryFile;
+				std::vector<bool> writtenFormats; /* format ids already in binaryFile */
+				if (!BinaryLogPath.empty())
+				{
+					binaryFile.open(BinaryLogPath, std::ios::binary | std::ios::app);
+					BinaryLog::WriteFileHeader(binaryFile, std::chrono::duration_cast<std::chrono::nanoseconds>(SystemAnchor.time_since_epoch()).count(), SteadyAnchor);
+				}
+
+				while (true)
+				{
+					{
+						std::lock_guard<std::mutex> lock(BuffersMutex);
+						buffers = Buffers;
+					}
+
+					/* take a batch from every thread, then put them back in sequence order */
+					lines.clear();
+					records.clear();
+					bool anyFull = false;
+					for (const std::shared_ptr<ThreadBuffer>& buffer : buffers)
+					{
+						size_t lineStart = lines.size();
+						lines.resize(lineStart + BatchSize);
+						size_t lineCount = buffer->Lines.TryPopBatch(lines.data() + lineStart, BatchSize);
+						lines.resize(lineStart + lineCount);
+
+						size_t recordStart = records.size();
+						records.resize(recordStart + BatchSize);
+						size_t recordCount = buffer->Records.TryPopBatch(records.data() + recordStart, BatchSize);
+						records.resize(recordStart + recordCount);
+
+						buffer->PoppedCount += lineCount + recordCount;
+						anyFull |= (lineCount == BatchSize || recordCount == BatchSize);
+					}
+
+					std::sort(lines.begin(), lines.end(), [](const StagedLine& left, const StagedLine& right) { return left.Sequence < right.Sequence; });
+					std::sort(records.begin(), records.end(), [](const BinaryLog::Record& left, const BinaryLog::Record& right) { return left.Sequence < right.Sequence; });
+
+					std::unique_lock<std::mutex> sinkLock(SinkMutex, std::defer_lock);
+					if (!lines.empty() || (!records.empty() && !binaryFile.is_open()))
+					{
+						sinkLock.lock();
+					}
 
-		std::wstring LogMessage;
-		Severity LogSeverity;
+					size_t lineIndex = 0;
+					for (const BinaryLog::Record& record : records)
+					{
+						if (binaryFile.is_open()) /* raw records go to their own file, no need to interleave */
+						{
+							if (writtenFormats.size() <= record.FormatId)
+							{
+								writtenFormats.resize((size_t)record.FormatId + 1);
+							}
+							if (!writtenFormats[record.FormatId])
+							{
+								BinaryLog::WriteFileFormat(binaryFile, record.FormatId, BinaryLog::FormatRegistry::Get(record.FormatId));
+								writtenFormats[record.FormatId] = true;
+							}
+							BinaryLog::WriteFileRecord(binaryFile, record);
+							continue;
+						}
+
+						for (; lineIndex < lines.size() && lines[lineIndex].Sequence < record.Sequence; lineIndex++)
+						{
+							WriteToSinks(lines[lineIndex].Line);
+						}
+						WriteToSinks(Logging::Retain(record, SystemAnchor + std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(record.Timestamp - SteadyAnchor))));
+					}
+					for (; lineIndex < lines.size(); lineIndex++)
+					{
+						WriteToSinks(lines[lineIndex].Line);
+					}
+					if (sinkLock.owns_lock())
+					{
+						sinkLock.unlock();
+					}
+
+					/* sites which stopped getting through still get what they suppressed reported */
+					std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+					if (now - lastSummary >= SummaryInterval)
+					{
+						lastSummary = now;
+						std::lock_guard<std::mutex> lock(SinkMutex);
+						LogSiteLimit::ForEach([&unflushed](LogSiteLimit& site)
+						{
+							uint64_t suppressed = site.TakeSuppressed();
+							if (suppressed != 0)
+							{
+								WriteToSinks(Logging::Retain(SuppressedSummary(site, suppressed), (Severity)site.Severity, std::chrono::system_clock::now(), NextSequence.fetch_add(1, std::memory_order_relaxed)));
+								unflushed = true;
+							}
+						});
+					}
+
+					size_t count = lines.size() + records.size();
+					unflushed |= (count != 0);
+
+					/* flush once the buffers run dry or the interval is up, whichever is first */
+					if (unflushed && (!anyFull || now - lastFlush >= FlushInterval))
+					{
+						FlushSinks();
+						binaryFile.flush();
+						unflushed = false;
+						lastFlush = now;
+
+						std::lock_guard<std::mutex> lock(WriterMutex);
+						for (const std::shared_ptr<ThreadBuffer>& buffer : buffers)
+						{
+							buffer->FlushedCount.store(buffer->PoppedCount);
+						}
+						FlushRequested = false;
+						FlushedCV.notify_all();
+					}
+
+					if (!unflushed) /* forget threads which are gone once everything they logged is out */
+					{
+						std::lock_guard<std::mutex> lock(BuffersMutex);
+						std::erase_if(Buffers, [](const std::shared_ptr<ThreadBuffer>& buffer)
+						{
+							return buffer->Abandoned.load(std::memory_order_acquire) && buffer->Empty() && buffer->FlushedCount.load() == buffer->EnqueuedCount.load();
+						});
+					}
+
+					if (count != 0)
+					{
+						continue;
+					}
+
+					std::unique_lock<std::mutex> lock(WriterMutex);
+					if (StopRequested && BuffersEmpty())
+					{
+						break;
+					}
+					WakeCV.wait_for(lock, FlushInterval, [this]() { return StopRequested || FlushRequested || !BuffersEmpty(); });
+					FlushRequested = false;
+				}
+			}
+		};
+
+		/// <summary>
+		/// fixed size ring of the most recent logs of one severity. slots are reused, so once every slot has
+		/// held a message of typical length logging doesn't allocate anymore
+		/// </summary>
+		class RetentionRing
+		{
+		public:
+			std::mutex RingMutex;					/* protects everything below */
+			size_t Capacity;						/* amount of slots (0 keeps nothing) */
+			std::unique_ptr<Logging[]> Slots;		/* allocated on first use */
+			uint64_t WrittenCount = 0;				/* logs ever written, next slot is WrittenCount % Capacity */
+
+			inline RetentionRing(const size_t& capacity)
+			{
+				Capacity = capacity;
+			}
+
+			/// <summary>
+			/// slot the next log goes into (overwrites the oldest once full). RingMutex has to be held
+			/// </summary>
+			/// <returns>slot or nullptr if the ring keeps nothing</returns>
+			inline Logging* NextSlot()
+			{
+				if (Capacity == 0)
+				{
+					return nullptr;
+				}
+
+				if (Slots == nullptr)
+				{
+					Slots.reset(new Logging[Capacity]);
+				}
+
+				return &Slots[WrittenCount++ % Capacity];
+			}
+		};
+
+		static inline RetentionRing Retention[(int)Severity::Fatal + 1] = {{256}, {256}, {256}, {128}, {32}};	/* default quota for each severity */
+		static inline std::atomic<uint64_t> NextSequence = 0;	/* orders logs across the rings */
+		static inline std::atomic<Verbose> VerboseLevel = Verbose::Warning;
+		static inline std::mutex SinkMutex;					/* protects Sinks and serializes writes to them */
+		static inline std::vector<std::shared_ptr<LogSink>> Sinks = {std::make_shared<StderrLogSink>(), std::make_shared<FileLogSink>("log.txt")};
+		/* declared after everything the writer thread uses, so at static destruction it gets destroyed (draining the queue) while those still exist */
+		static inline std::unique_ptr<AsyncWriter> Writer;	/* set while async logging is on */
+
+		/// <summary>
+		/// Says a sink threw. goes straight to stderr, the sinks can't be trusted with it
+		/// </summary>
+		static inline void ReportSinkFailure(const std::exception& exception)
+		{
+			fprintf(stderr, "NosLib::Logging: log sink failed: %s\n", exception.what());
+		}
+
+		/// <summary>
+		/// Hands a finished line to every sink. SinkMutex has to be held.
+		/// a sink throwing doesn't stop the others, or take down the writer thread
+		/// </summary>
+		static inline void WriteToSinks(const std::string& line)
+		{
+			for (const std::shared_ptr<LogSink>& sink : Sinks)
+			{
+				try
+				{
+					sink->Write(line);
+				}
+				catch (const std::exception& exception)
+				{
+					ReportSinkFailure(exception);
+				}
+			}
+		}
+
+		/// <summary>
+		/// the "suppressed N messages" line of a rate limited or sampled site
+		/// </summary>
+		static inline std::string SuppressedSummary(const LogSiteLimit& site, const uint64_t& suppressedCount)
+		{
+			return std::format("suppressed {} messages from {}:{}", suppressedCount, site.File, site.Line);
+		}
+
+		/// <summary>
+		/// Flushes every sink. SinkMutex has to be held
+		/// </summary>
+		static inline void FlushSinksLocked()
+		{
+			for (const std::shared_ptr<LogSink>& sink : Sinks)
+			{
+				try
+				{
+					sink->Flush();
+				}
+				catch (const std::exception& exception)
+				{
+					ReportSinkFailure(exception);
+				}
+			}
+		}
+
+		static inline void FlushSinks()
+		{
+			std::lock_guard<std::mutex> lock(SinkMutex);
+			FlushSinksLocked();
+		}
+
+		std::string LogMessage;		/* UTF-8 */
+		Severity LogSeverity = Severity::Debug;
 		std::chrono::system_clock::time_point LogTimestamp;
+		uint64_t LogSequence = 0;
 
 		inline constexpr Logging() {}
 
-		inline Logging(const std::wstring& logMessage, const Severity& logSeverity)
+		/// <summary>
+		/// Fills the log in place, reusing LogMessage's buffer. char messages are taken as UTF-8 and copied as is
+		/// </summary>
+		template<typename CharType>
+		inline void Assign(const std::basic_string<CharType>& logMessage, const Severity& logSeverity, const std::chrono::system_clock::time_point& logTimestamp, const uint64_t& logSequence)
 		{
-			LogMessage = logMessage + (logMessage.back() != L'\n' ? L"\n" : L"");
+			if constexpr (std::is_same_v<CharType, char>)
+			{
+				LogMessage.assign(logMessage);
+			}
+			else /* wide adapter */
+			{
+				LogMessage = NosLib::String::ConvertString<char, CharType>(logMessage);
+			}
+
+			if (LogMessage.empty() || LogMessage.back() != '\n')
+			{
+				LogMessage.push_back('\n');
+			}
+
 			LogSeverity = logSeverity;
-			LogTimestamp = std::chrono::system_clock::now();
+			LogTimestamp = logTimestamp;
+			LogSequence = logSequence;
+		}
+
+		/// <summary>
+		/// Keeps a log in the retention ring of its severity
+		/// </summary>
+		/// <returns>the formatted line</returns>
+		template<typename CharType>
+		static inline std::string Retain(const std::basic_string<CharType>& logMessage, const Severity& logSeverity, const std::chrono::system_clock::time_point& logTimestamp, const uint64_t& logSequence)
+		{
+			/* the line gets built before taking the lock, so threads logging at the same severity only serialize on the copy into the slot.
+			 * the scratch log is per thread so its buffer gets reused like the slots are */
+			static thread_local Logging scratchLog;
+			scratchLog.Assign(logMessage, logSeverity, logTimestamp, logSequence);
+			std::string line = scratchLog.GetLogUtf8();
+
+			RetentionRing& ring = Retention[(int)logSeverity];
+			std::lock_guard<std::mutex> lock(ring.RingMutex);
+			Logging* logObject = ring.NextSlot();
+
+			if (logObject != nullptr) /* otherwise not retained, still gets printed */
+			{
+				logObject->Assign(scratchLog.LogMessage, logSeverity, logTimestamp, logSequence);
+			}
+
+			return line;
 		}
 
-		static inline constexpr std::wstring SeverityToWstring(const Severity& logSeverity)
+		/// <summary>
+		/// Formats a binary record and keeps it like CreateLog would
+		/// </summary>
+		/// <returns>the formatted line</returns>
+		static inline std::string Retain(const BinaryLog::Record& record, const std::chrono::system_clock::time_point& logTimestamp)
+		{
+			Severity logSeverity = (record.Severity <= (uint8_t)Severity::Fatal ? (Severity)record.Severity : Severity::Fatal);
+			return Retain(BinaryLog::FormatRecord(BinaryLog::FormatRegistry::Get(record.FormatId), record), logSeverity, logTimestamp, record.Sequence);
+		}
+
+		static inline constexpr std::string_view SeverityToString(const Severity& logSeverity)
 		{
 			switch (logSeverity)
 			{
 			case NosLib::Logging::Severity::Debug:
-				return L"Debug";
+				return "Debug";
 				break;
 			case NosLib::Logging::Severity::Info:
-				return L"Info";
+				return "Info";
 				break;
 			case NosLib::Logging::Severity::Warning:
-				return L"Warning";
+				return "Warning";
 				break;
 			case NosLib::Logging::Severity::Error:
-				return L"Error";
+				return "Error";
 				break;
 			case NosLib::Logging::Severity::Fatal:
-				return L"Fatal";
+				return "Fatal";
 				break;
 			}
-			return L"UNKNOWN";
+			return "UNKNOWN";
 		}
 
 	public:
-		static inline constexpr void SetVerboseLevel(const Verbose& verboseLevel)
+		static inline void SetVerboseLevel(const Verbose& verboseLevel)
 		{
-			VerboseLevel = verboseLevel;
+			VerboseLevel.store(verboseLevel, std::memory_order_relaxed);
 		}
 
 		static inline Verbose GetVerboseLevel()
 		{
-			return VerboseLevel;
+			return VerboseLevel.load(std::memory_order_relaxed);
+		}
+
+		/// <summary>
+		/// if logs of a severity get through, both NOSLIB_LOG_MIN_SEVERITY and the verbose level. check this before building expensive messages
+		/// </summary>
+		/// <param name="logSeverity">- severity to check</param>
+		/// <returns>if it would be logged</returns>
+		static inline bool IsEnabled(const Severity& logSeverity)
+		{
+			return (int)logSeverity >= MinSeverity && (uint16_t)logSeverity >= (uint16_t)VerboseLevel.load(std::memory_order_relaxed);
+		}
+
+		/// <summary>
+		/// Formats and creates a log, formatting only happens if the severity is enabled. use NOSLIB_LOG to also skip evaluating the arguments
+		/// </summary>
+		/// <param name="logSeverity">- how severe it is</param>
+		/// <param name="format">- std::format format string</param>
+		/// <param name="args">- format arguments</param>
+		template<typename... FormatArgs>
+		static inline void Log(const Severity& logSeverity, std::format_string<FormatArgs...> format, FormatArgs&&... args)
+		{
+			if (!IsEnabled(logSeverity))
+			{
+				return;
+			}
+
+			CreateLog<char>(std::format(format, std::forward<FormatArgs>(args)...), logSeverity);
+		}
+
+		template<typename... FormatArgs>
+		static inline void Log(const Severity& logSeverity, std::wformat_string<FormatArgs...> format, FormatArgs&&... args)
+		{
+			if (!IsEnabled(logSeverity))
+			{
+				return;
+			}
+
+			CreateLog<wchar_t>(std::format(format, std::forward<FormatArgs>(args)...), logSeverity);
+		}
+
+		/// <summary>
+		/// Logs for a rate limited or sampled site which let the log through, reporting what the site suppressed before it.
+		/// use NOSLIB_LOG_RATE_LIMITED or NOSLIB_LOG_SAMPLED instead of calling this directly
+		/// </summary>
+		/// <param name="logSeverity">- how severe it is</param>
+		/// <param name="site">- the site's limiter or sampler</param>
+		/// <param name="format">- std::format format string</param>
+		/// <param name="args">- format arguments</param>
+		template<typename... FormatArgs>
+		static inline void LogLimited(const Severity& logSeverity, LogSiteLimit& site, std::format_string<FormatArgs...> format, FormatArgs&&... args)
+		{
+			uint64_t suppressed = site.TakeSuppressed();
+			if (suppressed != 0)
+			{
+				CreateLog<char>(SuppressedSummary(site, suppressed), logSeverity);
+			}
+
+			Log(logSeverity, format, std::forward<FormatArgs>(args)...);
+		}
+
+		/// <summary>
+		/// Reports the suppressed count of every rate limited and sampled site right away. the async writer does this every second by itself,
+		/// without it sites only report when their next log gets through
+		/// </summary>
+		static inline void ReportSuppressedLogs()
+		{
+			LogSiteLimit::ForEach([](LogSiteLimit& site)
+			{
+				uint64_t suppressed = site.TakeSuppressed();
+				if (suppressed != 0)
+				{
+					CreateLog<char>(SuppressedSummary(site, suppressed), (Severity)site.Severity);
+				}
+			});
+		}
+
+		/// <summary>
+		/// Logs without formatting on the calling thread. with the async writer running only the format id, a steady clock timestamp and the raw arguments
+		/// get queued, the writer formats them (or writes them to the binary log file for DecodeBinaryLog). without it, this is the same as Log.
+		/// use NOSLIB_LOG_BINARY instead of calling this directly, it makes the call site
+		/// </summary>
+		/// <param name="logSeverity">- how severe it is</param>
+		/// <param name="site">- the call site, has to always be used with the same format</param>
+		/// <param name="format">- std::format format string</param>
+		/// <param name="args">- format arguments (arithmetic, strings and pointers)</param>
+		template<typename... FormatArgs>
+		static inline void LogBinary(const Severity& logSeverity, BinaryLog::CallSite& site, std::format_string<FormatArgs...> format, FormatArgs&&... args)
+		{
+			if (!IsEnabled(logSeverity))
+			{
+				return;
+			}
+
+			if (Writer == nullptr)
+			{
+				CreateLog<char>(std::format(format, std::forward<FormatArgs>(args)...), logSeverity);
+				return;
+			}
+
+			BinaryLog::Record record;
+			record.Timestamp = BinaryLog::Now();
+			record.Sequence = NextSequence.fetch_add(1, std::memory_order_relaxed);
+			record.FormatId = site.GetId(format.get());
+			record.Severity = (uint8_t)logSeverity;
+			record.Encode(args...);
+
+			Writer->Enqueue(std::move(record));
+			if (logSeverity == Severity::Fatal) /* program is about to go down, make sure it's on disk */
+			{
+				Writer->Flush();
+			}
+		}
+
+		/// <summary>
+		/// Formats a binary log file written by the async writer
+		/// </summary>
+		/// <param name="stream">- the binary log file, opened in binary mode</param>
+		/// <param name="out">- where the formatted lines go</param>
+		/// <returns>amount of records decoded</returns>
+		static inline size_t DecodeBinaryLog(std::istream& stream, std::ostream& out)
+		{
+			BinaryLog::FileReader reader(stream);
+			BinaryLog::Record record;
+			Logging log;
+			size_t count = 0;
+
+			while (reader.Next(record))
+			{
+				Severity logSeverity = (record.Severity <= (uint8_t)Severity::Fatal ? (Severity)record.Severity : Severity::Fatal);
+				log.Assign(BinaryLog::FormatRecord(reader.GetFormat(record.FormatId), record), logSeverity, reader.ToSystemTime(record.Timestamp), record.Sequence);
+				out << log.GetLogUtf8();
+				count++;
+			}
+
+			out.flush();
+			return count;
+		}
+
+		/// <summary>
+		/// Switches to async logging. callers only format the log and stage it in a buffer of their own thread, a background thread merges
+		/// the buffers back into sequence order and writes lines out to the sinks in batches. call at startup, before other threads log
+		/// </summary>
+		/// <param name="bufferCapacity">(default = 1024) - most logs each thread can have waiting to be written</param>
+		/// <param name="policy">(default = OverflowPolicy::Block) - what to do when a thread's buffer is full</param>
+		/// <param name="flushInterval">(default = 100ms) - longest a line can wait before being flushed to disk</param>
+		/// <param name="binaryLogPath">(default = "") - if set, binary logs get appended to this file unformatted instead of going to the sinks (read it with DecodeBinaryLog)</param>
+		static inline void StartAsyncWriter(const size_t& bufferCapacity = 1024, const OverflowPolicy& policy = OverflowPolicy::Block,
+											const std::chrono::steady_clock::duration& flushInterval = std::chrono::milliseconds(100), const std::string& binaryLogPath = "")
+		{
+			if (Writer != nullptr)
+			{
+				throw std::logic_error("Async log writer is already running");
+			}
+
+			Writer = std::make_unique<AsyncWriter>(bufferCapacity, policy, flushInterval, binaryLogPath);
+		}
+
+		/// <summary>
+		/// Writes out everything queued and goes back to writing logs on the calling thread. call once other threads stopped logging
+		/// </summary>
+		static inline void StopAsyncWriter()
+		{
+			Writer.reset();
+		}
+
+		/// <summary>
+		/// Waits until every log queued so far has been written and flushed (does nothing without the async writer)
+		/// </summary>
+		static inline void Flush()
+		{
+			if (Writer != nullptr)
+			{
+				Writer->Flush();
+			}
 		}
 
+		/// <summary>
+		/// amount of logs thrown away because a thread's async buffer was full (OverflowPolicy::Drop)
+		/// </summary>
+		/// <returns>dropped log count</returns>
+		static inline uint64_t GetDroppedLogCount()
+		{
+			return (Writer != nullptr ? Writer->DroppedCount.load() : 0);
+		}
+
+		/// <summary>
+		/// Adds somewhere for logs to go, on top of the ones already there. by default logs go to stderr and log.txt
+		/// </summary>
+		/// <param name="sink">- the sink (StderrLogSink, FileLogSink, RotatingFileLogSink, MappedFileLogSink or your own)</param>
+		static inline void AddSink(const std::shared_ptr<LogSink>& sink)
+		{
+			std::lock_guard<std::mutex> lock(SinkMutex);
+			Sinks.push_back(sink);
+		}
+
+		/// <summary>
+		/// Removes a sink added with AddSink
+		/// </summary>
+		/// <param name="sink">- the sink</param>
+		static inline void RemoveSink(const std::shared_ptr<LogSink>& sink)
+		{
+			std::lock_guard<std::mutex> lock(SinkMutex);
+			std::erase(Sinks, sink);
+		}
+
+		/// <summary>
+		/// Removes every sink, including the default stderr and log.txt ones
+		/// </summary>
+		static inline void ClearSinks()
+		{
+			std::lock_guard<std::mutex> lock(SinkMutex);
+			Sinks.clear();
+		}
+
+		/// <summary>
+		/// Sets how many of the most recent logs of a severity get kept in memory (see GetRecentLogs)
+		/// </summary>
+		/// <param name="severity">- severity the quota is for</param>
+		/// <param name="capacity">- amount of logs to keep (0 keeps none)</param>
+		static inline void SetRetention(const Severity& severity, const size_t& capacity)
+		{
+			RetentionRing& ring = Retention[(int)severity];
+			std::lock_guard<std::mutex> lock(ring.RingMutex);
+			ring.Capacity = capacity;
+			ring.Slots.reset();
+			ring.WrittenCount = 0;
+		}
+
+		/// <summary>
+		/// Copies out every retained log, oldest first. meant for crash dumps and diagnostics
+		/// </summary>
+		/// <returns>retained logs</returns>
+		static inline std::vector<Logging> GetRecentLogs()
+		{
+			std::vector<Logging> recentLogs;
+
+			for (RetentionRing& ring : Retention)
+			{
+				std::lock_guard<std::mutex> lock(ring.RingMutex);
+				if (ring.Slots == nullptr)
+				{
+					continue;
+				}
+
+				uint64_t keptCount = std::min<uint64_t>(ring.WrittenCount, ring.Capacity);
+				for (uint64_t i = ring.WrittenCount - keptCount; i < ring.WrittenCount; i++)
+				{
+					recentLogs.push_back(ring.Slots[i % ring.Capacity]);
+				}
+			}
+
+			std::sort(recentLogs.begin(), recentLogs.end(), [](const Logging& left, const Logging& right) { return left.LogSequence < right.LogSequence; });
+			return recentLogs;
+		}
+
+		/// <summary>
+		/// Writes every retained log to stream (UTF-8), oldest first
+		/// </summary>
+		/// <param name="stream">- stream to write to</param>
+		static inline void DumpRecentLogs(std::ostream& stream)
+		{
+			for (const Logging& log : GetRecentLogs())
+			{
+				stream << log.GetLogUtf8();
+			}
+			stream.flush();
+		}
+
+		static inline void DumpRecentLogs(std::wostream& stream)
+		{
+			for (const Logging& log : GetRecentLogs())
+			{
+				stream << log.GetLog();
+			}
+			stream.flush();
+		}
+
+		/// <summary>
+		/// Creates a log. logs below the verbose level return straight away, the rest get kept in the retention ring of their severity and written to the sinks
+		/// </summary>
+		/// <typeparam name="CharType">- character type of the message</typeparam>
+		/// <param name="logMessage">- the message</param>
+		/// <param name="logSeverity">- how severe it is</param>
 		template<typename CharType>
-		static inline constexpr Logging* CreateLog(const std::basic_string<CharType>& logMessage, const Severity& logSeverity)
+		static inline void CreateLog(const std::basic_string<CharType>& logMessage, const Severity& logSeverity)
 		{
-			Logging* logObject = new Logging(NosLib::String::ConvertString<wchar_t, CharType>(logMessage), logSeverity);
-			Logs.Append(logObject);
+			/* if severity is lower then Verbose, then don't keep, print or add to file */
+			if (!IsEnabled(logSeverity))
+			{
+				return;
+			}
 
-			/* if severity is lower then Verbose, then don't print or add to file */
-			if ((uint16_t)logSeverity < (uint16_t)VerboseLevel)
+			uint64_t logSequence = NextSequence.fetch_add(1, std::memory_order_relaxed);
+			std::string containedLogMessage = Retain(logMessage, logSeverity, std::chrono::system_clock::now(), logSequence);
+
+			if (Writer != nullptr)
 			{
-				return logObject;
+				Writer->Enqueue(std::move(containedLogMessage), logSequence);
+				if (logSeverity == Severity::Fatal) /* program is about to go down, make sure it's on disk */
+				{
+					Writer->Flush();
+				}
+				return;
 			}
 
-			std::wstring containedLogMessage = logObject->GetLog();
-			fprintf(stderr, NosLib::String::ConvertString<char, wchar_t>(containedLogMessage).c_str());
+			std::lock_guard<std::mutex> lock(SinkMutex); /* keeps lines from different threads from interleaving */
+			WriteToSinks(containedLogMessage);
+			FlushSinksLocked(); /* nothing batches up without the writer, so get it out now */
+		}
 
-			std::wofstream outLog("log.txt", std::ios::binary | std::ios::app);
-			outLog.write(containedLogMessage.c_str(), containedLogMessage.size());
-			outLog.close();
+		inline Severity GetSeverity() const
+		{
+			return LogSeverity;
+		}
 
-			return logObject;
+		inline std::chrono::system_clock::time_point GetTimestamp() const
+		{
+			return LogTimestamp;
 		}
 
-		inline std::wstring GetLog() const
+		/// <summary>
+		/// the finished line, as it gets written to the sinks
+		/// </summary>
+		/// <returns>UTF-8 line</returns>
+		inline std::string GetLogUtf8() const
 		{
+			static const std::chrono::time_zone* zone = std::chrono::current_zone(); /* the lookup isn't free, and the zone doesn't change under a running program */
+
 			// %d/%m/%Y for date too
-			return std::format(L"({}) {:%X} {}", SeverityToWstring(LogSeverity), std::chrono::zoned_time(std::chrono::current_zone(), LogTimestamp), LogMessage);
+			return std::format("({}) {:%X} {}", SeverityToString(LogSeverity), std::chrono::zoned_time(zone, LogTimestamp), LogMessage);
+		}
+
+		/// <summary>
+		/// the finished line, converted from UTF-8 (see GetLogUtf8)
+		/// </summary>
+		inline std::wstring GetLog() const
+		{
+			return NosLib::String::ConvertString<wchar_t, char>(GetLogUtf8());
 		}
 	};
 }
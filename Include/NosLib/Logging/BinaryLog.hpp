@@ -0,0 +1,575 @@
+#ifndef _BINARYLOG_NOSLIB_HPP_
+#define _BINARYLOG_NOSLIB_HPP_
+
+#include <atomic>
+#include <mutex>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <format>
+#include <cstring>
+#include <cstdint>
+#include <type_traits>
+#include <chrono>
+#include <istream>
+#include <ostream>
+
+namespace NosLib
+{
+	namespace BinaryLog
+	{
+		/// <summary>
+		/// steady clock time in nanoseconds, what binary records are stamped with (no timezone lookup on the hot path)
+		/// </summary>
+		inline int64_t Now()
+		{
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+		}
+
+		/* tag written before every argument in a record */
+		enum class ArgumentType : uint8_t
+		{
+			Int,		/* any signed integer, stored as int64_t */
+			UInt,		/* any unsigned integer, stored as uint64_t */
+			Double,		/* any floating point, stored as double */
+			Bool,
+			Char,
+			String,		/* uint16_t length followed by the bytes */
+			Pointer,	/* stored as uint64_t */
+		};
+
+		/// <summary>
+		/// every format string a binary log has used, a record only stores its id. ids stay valid for the whole program
+		/// </summary>
+		class FormatRegistry
+		{
+		protected:
+			static inline std::mutex RegistryMutex;
+			static inline std::deque<std::string> Formats; /* deque so references handed out stay valid */
+
+		public:
+			/// <summary>
+			/// Adds a format string
+			/// </summary>
+			/// <param name="format">- the format string</param>
+			/// <returns>id of the format</returns>
+			static inline uint32_t Register(const std::string_view& format)
+			{
+				std::lock_guard<std::mutex> lock(RegistryMutex);
+				Formats.emplace_back(format);
+				return (uint32_t)(Formats.size() - 1);
+			}
+
+			/// <summary>
+			/// format string registered under id
+			/// </summary>
+			/// <param name="id">- id from Register</param>
+			/// <returns>the format string, empty if id isn't registered</returns>
+			static inline const std::string& Get(const uint32_t& id)
+			{
+				static const std::string unknown;
+				std::lock_guard<std::mutex> lock(RegistryMutex);
+				return (id < Formats.size() ? Formats[id] : unknown);
+			}
+
+			static inline size_t GetCount()
+			{
+				std::lock_guard<std::mutex> lock(RegistryMutex);
+				return Formats.size();
+			}
+		};
+
+		/// <summary>
+		/// one per log call site (a static made by NOSLIB_LOG_BINARY), registers its format string on first use.
+		/// two threads hitting a new site at the same time can register it twice, which only wastes an id
+		/// </summary>
+		class CallSite
+		{
+		protected:
+			std::atomic<uint32_t> Id = 0; /* FormatRegistry id + 1, 0 until first use */
+
+		public:
+			inline uint32_t GetId(const std::string_view& format)
+			{
+				uint32_t id = Id.load(std::memory_order_acquire);
+				if (id == 0)
+				{
+					id = FormatRegistry::Register(format) + 1;
+					Id.store(id, std::memory_order_release);
+				}
+				return id - 1;
+			}
+		};
+
+		/// <summary>
+		/// a log which hasn't been formatted yet. fixed size and trivially copyable so it can go through a queue without allocating,
+		/// string arguments which don't fit in the payload get cut short
+		/// </summary>
+		struct Record
+		{
+			static constexpr size_t PayloadCapacity = 232;
+
+			int64_t Timestamp = 0;		/* steady clock nanoseconds (see Now) */
+			uint64_t Sequence = 0;		/* orders records against other logs */
+			uint32_t FormatId = 0;		/* FormatRegistry id */
+			uint8_t Severity = 0;		/* Logging::Severity */
+			bool Full = false;			/* an argument didn't fit, the ones after it got dropped too so they don't land on the wrong placeholders */
+			uint16_t Size = 0;			/* bytes of Payload used */
+			unsigned char Payload[PayloadCapacity];
+
+			/// <summary>
+			/// Appends arguments to the payload
+			/// </summary>
+			template<typename... ArgumentTypes>
+			inline void Encode(const ArgumentTypes&... arguments)
+			{
+				(Put(arguments), ...);
+			}
+
+		protected:
+			template<typename>
+			static constexpr bool UnsupportedArgument = false;
+
+			inline bool PutRaw(const ArgumentType& type, const void* data, const size_t& size)
+			{
+				if (Full || Size + 1 + size > PayloadCapacity)
+				{
+					Full = true;
+					return false;
+				}
+
+				Payload[Size] = (unsigned char)type;
+				std::memcpy(Payload + Size + 1, data, size);
+				Size += (uint16_t)(1 + size);
+				return true;
+			}
+
+			template<typename ArgumentType_>
+			inline void Put(const ArgumentType_& argument)
+			{
+				using ValueType = std::remove_cvref_t<ArgumentType_>;
+
+				if constexpr (std::is_same_v<ValueType, bool>)
+				{
+					PutRaw(ArgumentType::Bool, &argument, 1);
+				}
+				else if constexpr (std::is_same_v<ValueType, char>)
+				{
+					PutRaw(ArgumentType::Char, &argument, 1);
+				}
+				else if constexpr (std::is_integral_v<ValueType> && std::is_signed_v<ValueType>)
+				{
+					int64_t value = argument;
+					PutRaw(ArgumentType::Int, &value, sizeof(value));
+				}
+				else if constexpr (std::is_integral_v<ValueType>)
+				{
+					uint64_t value = argument;
+					PutRaw(ArgumentType::UInt, &value, sizeof(value));
+				}
+				else if constexpr (std::is_floating_point_v<ValueType>)
+				{
+					double value = (double)argument;
+					PutRaw(ArgumentType::Double, &value, sizeof(value));
+				}
+				else if constexpr (std::is_convertible_v<const ValueType&, std::string_view>)
+				{
+					if (Full || (size_t)Size + 3 > PayloadCapacity)
+					{
+						Full = true;
+						return;
+					}
+
+					std::string_view text = argument;
+					size_t room = PayloadCapacity - Size - 3;
+					uint16_t length = (uint16_t)(text.size() < room ? text.size() : room); /* cut short instead of dropped, the start is usually what matters */
+
+					Payload[Size] = (unsigned char)ArgumentType::String;
+					std::memcpy(Payload + Size + 1, &length, sizeof(length));
+					std::memcpy(Payload + Size + 3, text.data(), length);
+					Size += (uint16_t)(3 + length);
+				}
+				else if constexpr (std::is_pointer_v<ValueType> || std::is_null_pointer_v<ValueType>)
+				{
+					uint64_t value = (uint64_t)(uintptr_t)(const void*)argument;
+					PutRaw(ArgumentType::Pointer, &value, sizeof(value));
+				}
+				else
+				{
+					static_assert(UnsupportedArgument<ValueType>, "binary logs only take arithmetic, string and pointer arguments, use Logging::Log for anything else");
+				}
+			}
+		};
+
+		/// <summary>
+		/// Formats a record's arguments into its format string. done by the writer thread or the decoder, never by the thread logging
+		/// </summary>
+		/// <param name="format">- format string the record was logged with</param>
+		/// <param name="record">- the record</param>
+		/// <returns>formatted message</returns>
+		inline std::string FormatRecord(const std::string_view& format, const Record& record)
+		{
+			/* decoded argument, only the member matching Type is set */
+			struct Argument
+			{
+				ArgumentType Type;
+				int64_t Int = 0;
+				uint64_t UInt = 0;
+				double Double = 0;
+				bool Bool = false;
+				char Char = 0;
+				std::string_view Text;
+				const void* Pointer = nullptr;
+			};
+
+			/* explicit index if there is one, otherwise the next automatic one */
+			auto parseIndex = [](const std::string_view& index, size_t& nextArgument)
+			{
+				if (index.empty())
+				{
+					return nextArgument++;
+				}
+
+				size_t out = 0;
+				for (char digit : index)
+				{
+					out = out * 10 + (size_t)(digit - '0');
+				}
+				return out;
+			};
+
+			Argument arguments[Record::PayloadCapacity / 2];
+			size_t argumentCount = 0;
+
+			/* bytes each argument type takes after its tag (just the length for String) */
+			constexpr size_t argumentSizes[] = {sizeof(int64_t), sizeof(uint64_t), sizeof(double), 1, 1, 2, sizeof(uint64_t)};
+
+			for (size_t position = 0; position < record.Size;)
+			{
+				Argument& argument = arguments[argumentCount];
+				argument.Type = (ArgumentType)record.Payload[position++];
+
+				if ((size_t)argument.Type >= sizeof(argumentSizes) / sizeof(argumentSizes[0]) || position + argumentSizes[(size_t)argument.Type] > record.Size)
+				{
+					break; /* corrupt, stop decoding */
+				}
+
+				switch (argument.Type)
+				{
+				case ArgumentType::Int:
+					std::memcpy(&argument.Int, record.Payload + position, sizeof(int64_t));
+					position += sizeof(int64_t);
+					break;
+				case ArgumentType::UInt:
+					std::memcpy(&argument.UInt, record.Payload + position, sizeof(uint64_t));
+					position += sizeof(uint64_t);
+					break;
+				case ArgumentType::Double:
+					std::memcpy(&argument.Double, record.Payload + position, sizeof(double));
+					position += sizeof(double);
+					break;
+				case ArgumentType::Bool:
+					argument.Bool = (record.Payload[position++] != 0);
+					break;
+				case ArgumentType::Char:
+					argument.Char = (char)record.Payload[position++];
+					break;
+				case ArgumentType::String:
+				{
+					uint16_t length;
+					std::memcpy(&length, record.Payload + position, sizeof(length));
+					if (position + 2 + length > record.Size)
+					{
+						position = record.Size;
+						continue;
+					}
+					argument.Text = std::string_view((const char*)record.Payload + position + 2, length);
+					position += 2 + (size_t)length;
+					break;
+				}
+				case ArgumentType::Pointer:
+				{
+					uint64_t value;
+					std::memcpy(&value, record.Payload + position, sizeof(value));
+					argument.Pointer = (const void*)(uintptr_t)value;
+					position += sizeof(value);
+					break;
+				}
+				}
+
+				argumentCount++;
+			}
+
+			std::string out;
+			out.reserve(format.size() + record.Size);
+			size_t nextArgument = 0;
+
+			for (size_t i = 0; i < format.size(); i++)
+			{
+				char character = format[i];
+				if ((character == '{' || character == '}') && i + 1 < format.size() && format[i + 1] == character) /* {{ or }} */
+				{
+					out.push_back(character);
+					i++;
+					continue;
+				}
+				if (character != '{')
+				{
+					out.push_back(character);
+					continue;
+				}
+
+				/* find the matching '}', dynamic width and precision ({:{}.{}}) nest fields inside the spec */
+				size_t end = i + 1;
+				for (int depth = 1; end < format.size(); end++)
+				{
+					if (format[end] == '{')
+					{
+						depth++;
+					}
+					else if (format[end] == '}' && --depth == 0)
+					{
+						break;
+					}
+				}
+				if (end >= format.size())
+				{
+					out.append(format.substr(i));
+					break;
+				}
+
+				/* {index:spec}, index is optional */
+				std::string_view field = format.substr(i + 1, end - i - 1);
+				size_t colon = field.find(':');
+				size_t argumentIndex = parseIndex(field.substr(0, colon), nextArgument);
+				i = end;
+
+				/* nested fields become the literal number they refer to, numbered after the field itself like std::format does */
+				bool valid = (argumentIndex < argumentCount); /* false if cut off by a full payload */
+				std::string spec = "{";
+				if (colon != std::string_view::npos)
+				{
+					std::string_view specText = field.substr(colon);
+					for (size_t j = 0; j < specText.size(); j++)
+					{
+						if (specText[j] != '{')
+						{
+							spec.push_back(specText[j]);
+							continue;
+						}
+
+						size_t nestedEnd = specText.find('}', j); /* always there, the depth count above matched it */
+						size_t nestedIndex = parseIndex(specText.substr(j + 1, nestedEnd - j - 1), nextArgument);
+						j = nestedEnd;
+
+						if (nestedIndex >= argumentCount)
+						{
+							valid = false;
+						}
+						else if (arguments[nestedIndex].Type == ArgumentType::Int && arguments[nestedIndex].Int >= 0) /* a '-' would read as the sign option */
+						{
+							spec.append(std::to_string(arguments[nestedIndex].Int));
+						}
+						else if (arguments[nestedIndex].Type == ArgumentType::UInt)
+						{
+							spec.append(std::to_string(arguments[nestedIndex].UInt));
+						}
+						else /* width and precision have to be integers */
+						{
+							valid = false;
+						}
+					}
+				}
+				spec.push_back('}');
+
+				if (!valid)
+				{
+					out.append("{?}");
+					continue;
+				}
+
+				Argument& argument = arguments[argumentIndex];
+				try
+				{
+					switch (argument.Type)
+					{
+					case ArgumentType::Int:
+						out.append(std::vformat(spec, std::make_format_args(argument.Int)));
+						break;
+					case ArgumentType::UInt:
+						out.append(std::vformat(spec, std::make_format_args(argument.UInt)));
+						break;
+					case ArgumentType::Double:
+						out.append(std::vformat(spec, std::make_format_args(argument.Double)));
+						break;
+					case ArgumentType::Bool:
+						out.append(std::vformat(spec, std::make_format_args(argument.Bool)));
+						break;
+					case ArgumentType::Char:
+						out.append(std::vformat(spec, std::make_format_args(argument.Char)));
+						break;
+					case ArgumentType::String:
+						out.append(std::vformat(spec, std::make_format_args(argument.Text)));
+						break;
+					case ArgumentType::Pointer:
+						out.append(std::vformat(spec, std::make_format_args(argument.Pointer)));
+						break;
+					}
+				}
+				catch (const std::format_error&) /* spec only made sense for the original type (like {:x} on a float) */
+				{
+					out.append("{?}");
+				}
+			}
+
+			return out;
+		}
+
+		/* what each entry in a binary log file starts with */
+		enum class FileEntryType : uint8_t
+		{
+			Header,		/* magic, system clock and steady clock nanoseconds taken at the same time */
+			Format,		/* format id, uint32_t length, the format string */
+			Record,		/* Record fields, then Size bytes of payload */
+		};
+
+		inline constexpr char FileMagic[8] = {'N', 'O', 'S', 'B', 'L', 'O', 'G', '1'};
+
+		/// <summary>
+		/// Writes the file header. the clock pair is how steady clock timestamps get turned back into wall time
+		/// </summary>
+		inline void WriteFileHeader(std::ostream& stream, const int64_t& systemNanoseconds, const int64_t& steadyNanoseconds)
+		{
+			stream.put((char)FileEntryType::Header);
+			stream.write(FileMagic, sizeof(FileMagic));
+			stream.write((const char*)&systemNanoseconds, sizeof(systemNanoseconds));
+			stream.write((const char*)&steadyNanoseconds, sizeof(steadyNanoseconds));
+		}
+
+		inline void WriteFileFormat(std::ostream& stream, const uint32_t& id, const std::string_view& format)
+		{
+			uint32_t length = (uint32_t)format.size();
+			stream.put((char)FileEntryType::Format);
+			stream.write((const char*)&id, sizeof(id));
+			stream.write((const char*)&length, sizeof(length));
+			stream.write(format.data(), length);
+		}
+
+		/// <summary>
+		/// Writes a record as is (native endianness, meant to be decoded on the same kind of machine)
+		/// </summary>
+		inline void WriteFileRecord(std::ostream& stream, const Record& record)
+		{
+			stream.put((char)FileEntryType::Record);
+			stream.write((const char*)&record.Timestamp, sizeof(record.Timestamp));
+			stream.write((const char*)&record.Sequence, sizeof(record.Sequence));
+			stream.write((const char*)&record.FormatId, sizeof(record.FormatId));
+			stream.write((const char*)&record.Severity, sizeof(record.Severity));
+			stream.write((const char*)&record.Full, sizeof(record.Full));
+			stream.write((const char*)&record.Size, sizeof(record.Size));
+			stream.write((const char*)record.Payload, record.Size);
+		}
+
+		/// <summary>
+		/// reads a binary log file back one record at a time, picking up formats and the clock pair along the way
+		/// </summary>
+		class FileReader
+		{
+		protected:
+			std::istream& Stream;
+			std::deque<std::string> Formats;
+
+		public:
+			int64_t SystemNanoseconds = 0;	/* wall time matching SteadyNanoseconds */
+			int64_t SteadyNanoseconds = 0;
+
+			inline FileReader(std::istream& stream)
+				: Stream(stream) {}
+
+			/// <summary>
+			/// Reads up to and including the next record
+			/// </summary>
+			/// <param name="out">- record read</param>
+			/// <returns>false at the end of the file or if it's corrupt</returns>
+			inline bool Next(Record& out)
+			{
+				int entryType;
+				while ((entryType = Stream.get()) != std::istream::traits_type::eof())
+				{
+					switch ((FileEntryType)entryType)
+					{
+					case FileEntryType::Header:
+					{
+						char magic[sizeof(FileMagic)];
+						Stream.read(magic, sizeof(magic));
+						if (!Stream || std::memcmp(magic, FileMagic, sizeof(magic)) != 0)
+						{
+							return false;
+						}
+						Stream.read((char*)&SystemNanoseconds, sizeof(SystemNanoseconds));
+						Stream.read((char*)&SteadyNanoseconds, sizeof(SteadyNanoseconds));
+						break;
+					}
+					case FileEntryType::Format:
+					{
+						uint32_t id, length;
+						Stream.read((char*)&id, sizeof(id));
+						Stream.read((char*)&length, sizeof(length));
+						if (!Stream)
+						{
+							return false;
+						}
+						if (Formats.size() <= id)
+						{
+							Formats.resize((size_t)id + 1);
+						}
+						Formats[id].resize(length);
+						Stream.read(Formats[id].data(), length);
+						break;
+					}
+					case FileEntryType::Record:
+						Stream.read((char*)&out.Timestamp, sizeof(out.Timestamp));
+						Stream.read((char*)&out.Sequence, sizeof(out.Sequence));
+						Stream.read((char*)&out.FormatId, sizeof(out.FormatId));
+						Stream.read((char*)&out.Severity, sizeof(out.Severity));
+						Stream.read((char*)&out.Full, sizeof(out.Full));
+						Stream.read((char*)&out.Size, sizeof(out.Size));
+						if (!Stream || out.Size > Record::PayloadCapacity)
+						{
+							return false;
+						}
+						Stream.read((char*)out.Payload, out.Size);
+						return (bool)Stream;
+					default:
+						return false;
+					}
+
+					if (!Stream)
+					{
+						return false;
+					}
+				}
+
+				return false;
+			}
+
+			/// <summary>
+			/// format string of id, as read from the file so far
+			/// </summary>
+			inline std::string_view GetFormat(const uint32_t& id) const
+			{
+				return (id < Formats.size() ? std::string_view(Formats[id]) : std::string_view());
+			}
+
+			/// <summary>
+			/// wall clock time of a record's timestamp
+			/// </summary>
+			inline std::chrono::system_clock::time_point ToSystemTime(const int64_t& timestamp) const
+			{
+				return std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(SystemNanoseconds + (timestamp - SteadyNanoseconds))));
+			}
+		};
+	}
+}
+
+#endif /* _BINARYLOG_NOSLIB_HPP_ */
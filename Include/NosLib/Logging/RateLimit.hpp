@@ -0,0 +1,177 @@
+#ifndef _RATELIMIT_NOSLIB_HPP_
+#define _RATELIMIT_NOSLIB_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace NosLib
+{
+	/// <summary>
+	/// base of rate limited and sampled log sites, counts what got suppressed. every site is linked into one list so the
+	/// async writer can report suppressed counts of sites which went quiet. sites are statics made by the macros and never unlinked
+	/// </summary>
+	class LogSiteLimit
+	{
+	protected:
+		static inline std::atomic<LogSiteLimit*> FirstSite = nullptr;
+
+		LogSiteLimit* NextSite = nullptr;
+		std::atomic<uint64_t> SuppressedCount = 0;	/* logs thrown away since the last summary */
+
+		static inline int64_t Now()
+		{
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+		}
+
+		inline void Suppress()
+		{
+			SuppressedCount.fetch_add(1, std::memory_order_relaxed);
+		}
+
+	public:
+		const char* File;	/* where the site is, for the summary */
+		int Line;
+		uint8_t Severity;	/* Logging::Severity the site logs at */
+
+		inline LogSiteLimit(const char* file, const int& line, const uint8_t& severity)
+			: File(file), Line(line), Severity(severity)
+		{
+			NextSite = FirstSite.load(std::memory_order_relaxed);
+			while (!FirstSite.compare_exchange_weak(NextSite, this, std::memory_order_release, std::memory_order_relaxed)) {}
+		}
+
+		LogSiteLimit(const LogSiteLimit&) = delete;
+		LogSiteLimit& operator=(const LogSiteLimit&) = delete;
+
+		/// <summary>
+		/// Takes the suppressed count, resetting it
+		/// </summary>
+		/// <returns>logs suppressed since the last call</returns>
+		inline uint64_t TakeSuppressed()
+		{
+			if (SuppressedCount.load(std::memory_order_relaxed) == 0) /* don't dirty the line for nothing */
+			{
+				return 0;
+			}
+			return SuppressedCount.exchange(0, std::memory_order_relaxed);
+		}
+
+		/// <summary>
+		/// Calls function with every site made so far
+		/// </summary>
+		template<typename Callable>
+		static inline void ForEach(Callable&& function)
+		{
+			for (LogSiteLimit* site = FirstSite.load(std::memory_order_acquire); site != nullptr; site = site->NextSite)
+			{
+				function(*site);
+			}
+		}
+	};
+
+	/// <summary>
+	/// token bucket for one log site, done as GCRA so the whole state is one atomic timestamp
+	/// </summary>
+	class LogRateLimiter : public LogSiteLimit
+	{
+	protected:
+		int64_t Interval;		/* nanoseconds one token takes to refill */
+		int64_t Tolerance;		/* how far ahead of schedule the burst lets a log be */
+		std::atomic<int64_t> TheoreticalArrival = 0;
+
+	public:
+		/// <summary>
+		/// Makes a limiter
+		/// </summary>
+		/// <param name="file">- file of the site</param>
+		/// <param name="line">- line of the site</param>
+		/// <param name="severity">- severity the site logs at</param>
+		/// <param name="perSecond">- logs allowed per second on average</param>
+		/// <param name="burst">(default = 1) - logs allowed back to back before the rate kicks in</param>
+		inline LogRateLimiter(const char* file, const int& line, const uint8_t& severity, const double& perSecond, const unsigned int& burst = 1)
+			: LogSiteLimit(file, line, severity)
+		{
+			double interval = (perSecond > 0 ? 1e9 / perSecond : 1e18); /* capped so the arithmetic can't overflow */
+			double tolerance = interval * (burst > 1 ? burst - 1 : 0);
+			Interval = (int64_t)(interval < 1e18 ? interval : 1e18);
+			Tolerance = (int64_t)(tolerance < 1e18 ? tolerance : 1e18);
+		}
+
+		/// <summary>
+		/// Takes a token
+		/// </summary>
+		/// <returns>true if the log can go ahead, false if it got suppressed</returns>
+		inline bool TryAcquire()
+		{
+			int64_t now = Now();
+			int64_t arrival = TheoreticalArrival.load(std::memory_order_relaxed);
+			int64_t nextArrival;
+
+			do
+			{
+				if (arrival - Tolerance > now)
+				{
+					Suppress();
+					return false;
+				}
+				nextArrival = (arrival > now ? arrival : now) + Interval;
+			} while (!TheoreticalArrival.compare_exchange_weak(arrival, nextArrival, std::memory_order_relaxed));
+
+			return true;
+		}
+	};
+
+	/// <summary>
+	/// lets a random fraction of a log site's logs through
+	/// </summary>
+	class LogSampler : public LogSiteLimit
+	{
+	protected:
+		uint64_t Threshold;		/* random values below this pass */
+		bool Always;
+
+	public:
+		/// <summary>
+		/// Makes a sampler
+		/// </summary>
+		/// <param name="file">- file of the site</param>
+		/// <param name="line">- line of the site</param>
+		/// <param name="severity">- severity the site logs at</param>
+		/// <param name="probability">- chance of a log going through, between 0 and 1</param>
+		inline LogSampler(const char* file, const int& line, const uint8_t& severity, const double& probability)
+			: LogSiteLimit(file, line, severity)
+		{
+			Always = (probability >= 1);
+			Threshold = (probability <= 0 ? 0 : (uint64_t)(probability * 18446744073709551616.0));
+		}
+
+		/// <summary>
+		/// Rolls for a log
+		/// </summary>
+		/// <returns>true if the log can go ahead, false if it got suppressed</returns>
+		inline bool ShouldLog()
+		{
+			if (Always)
+			{
+				return true;
+			}
+
+			/* xorshift64*, one state per thread so rolls don't contend */
+			thread_local uint64_t state = 0x9E3779B97F4A7C15ull ^ (uint64_t)(uintptr_t)&state ^ (uint64_t)Now();
+			state ^= state >> 12;
+			state ^= state << 25;
+			state ^= state >> 27;
+
+			if (state * 0x2545F4914F6CDD1Dull < Threshold)
+			{
+				return true;
+			}
+
+			Suppress();
+			return false;
+		}
+	};
+}
+
+#endif /* _RATELIMIT_NOSLIB_HPP_ */
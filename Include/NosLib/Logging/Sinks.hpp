@@ -0,0 +1,384 @@
+#ifndef _SINKS_NOSLIB_HPP_
+#define _SINKS_NOSLIB_HPP_
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif // _WIN32
+
+#include <string>
+#include <string_view>
+#include <fstream>
+#include <filesystem>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <stdexcept>
+
+namespace NosLib
+{
+	/// <summary>
+	/// somewhere finished log lines go (see Logging::AddSink). Write only ever gets called by one thread at a time
+	/// </summary>
+	class LogSink
+	{
+	public:
+		virtual ~LogSink() = default;
+
+		/// <summary>
+		/// Writes one finished line (ends with a newline)
+		/// </summary>
+		/// <param name="line">- the line</param>
+		virtual void Write(const std::string_view& line) = 0;
+
+		/// <summary>
+		/// Pushes buffered lines out to the OS
+		/// </summary>
+		virtual void Flush() {}
+	};
+
+	/// <summary>
+	/// writes to stderr
+	/// </summary>
+	class StderrLogSink : public LogSink
+	{
+	public:
+		inline void Write(const std::string_view& line) override
+		{
+			fwrite(line.data(), 1, line.size(), stderr);
+		}
+
+		inline void Flush() override
+		{
+			fflush(stderr);
+		}
+	};
+
+	/// <summary>
+	/// appends to a file it keeps open. the file only gets opened (and created) by the first write
+	/// </summary>
+	class FileLogSink : public LogSink
+	{
+	protected:
+		std::filesystem::path Path;
+		std::ofstream Stream;
+
+	public:
+		inline FileLogSink(const std::filesystem::path& path)
+			: Path(path) {}
+
+		inline void Write(const std::string_view& line) override
+		{
+			if (!Stream.is_open())
+			{
+				Stream.open(Path, std::ios::binary | std::ios::app);
+			}
+			Stream.write(line.data(), line.size());
+		}
+
+		inline void Flush() override
+		{
+			Stream.flush();
+		}
+	};
+
+	/// <summary>
+	/// appends to a file and rotates it once it gets too big or too old. path becomes path.1, path.1 becomes path.2 and so on,
+	/// anything past maxFiles gets deleted
+	/// </summary>
+	class RotatingFileLogSink : public FileLogSink
+	{
+	protected:
+		uintmax_t MaxBytes;
+		std::chrono::system_clock::duration RotateInterval;
+		unsigned int MaxFiles;
+
+		uintmax_t WrittenBytes = 0;
+		std::chrono::system_clock::time_point OpenedAt = std::chrono::system_clock::now();
+
+		inline std::filesystem::path RotatedPath(const unsigned int& index) const
+		{
+			std::filesystem::path rotatedPath = Path;
+			rotatedPath += "." + std::to_string(index);
+			return rotatedPath;
+		}
+
+	public:
+		/// <summary>
+		/// Opens (or continues) the log file
+		/// </summary>
+		/// <param name="path">- file to write to</param>
+		/// <param name="maxBytes">(default = 10MB) - size it gets rotated at (0 = no size limit)</param>
+		/// <param name="rotateInterval">(default = 0) - age it gets rotated at (0 = no age limit)</param>
+		/// <param name="maxFiles">(default = 5) - rotated files kept around</param>
+		inline RotatingFileLogSink(const std::filesystem::path& path, const uintmax_t& maxBytes = 10 * 1024 * 1024,
+								   const std::chrono::system_clock::duration& rotateInterval = std::chrono::system_clock::duration::zero(), const unsigned int& maxFiles = 5)
+			: FileLogSink(path), MaxBytes(maxBytes), RotateInterval(rotateInterval), MaxFiles(maxFiles)
+		{
+			std::error_code error;
+			uintmax_t existingBytes = std::filesystem::file_size(Path, error);
+			WrittenBytes = (error ? 0 : existingBytes);
+		}
+
+		inline void Write(const std::string_view& line) override
+		{
+			bool tooBig = (MaxBytes != 0 && WrittenBytes != 0 && WrittenBytes + line.size() > MaxBytes);
+			bool tooOld = (RotateInterval != std::chrono::system_clock::duration::zero() && std::chrono::system_clock::now() - OpenedAt >= RotateInterval);
+			if (tooBig || tooOld)
+			{
+				Rotate();
+			}
+
+			FileLogSink::Write(line);
+			WrittenBytes += line.size();
+		}
+
+		/// <summary>
+		/// Moves the current file out of the way and starts a new one
+		/// </summary>
+		inline void Rotate()
+		{
+			Stream.close();
+
+			std::error_code error; /* a missing file in the chain isn't a problem */
+			std::filesystem::remove(RotatedPath(MaxFiles), error);
+			for (unsigned int i = MaxFiles; i > 1; i--)
+			{
+				std::filesystem::rename(RotatedPath(i - 1), RotatedPath(i), error);
+			}
+			if (MaxFiles != 0)
+			{
+				std::filesystem::rename(Path, RotatedPath(1), error);
+			}
+			else
+			{
+				std::filesystem::remove(Path, error);
+			}
+
+			Stream.open(Path, std::ios::binary | std::ios::trunc);
+			WrittenBytes = 0;
+			OpenedAt = std::chrono::system_clock::now();
+		}
+	};
+
+	/// <summary>
+	/// appends to a memory mapped file, a write is just a memcpy into the mapping. the file gets grown a window at a time
+	/// and cut back to what was written when the sink is destroyed (after a crash it can end in zeros)
+	/// </summary>
+	class MappedFileLogSink : public LogSink
+	{
+	protected:
+		size_t WindowSize;				/* bytes mapped at once */
+		uint64_t WindowStart = 0;		/* file offset the mapping starts at */
+		size_t WindowPosition = 0;		/* next byte to write in the mapping */
+		char* Window = nullptr;
+
+	#ifdef _WIN32
+		HANDLE File = INVALID_HANDLE_VALUE;
+		HANDLE Mapping = nullptr;
+	#else
+		int File = -1;
+	#endif // _WIN32
+
+		/// <summary>
+		/// alignment a mapping has to start at
+		/// </summary>
+		static inline uint64_t Granularity()
+		{
+		#ifdef _WIN32
+			SYSTEM_INFO systemInfo;
+			GetSystemInfo(&systemInfo);
+			return systemInfo.dwAllocationGranularity;
+		#else
+			return (uint64_t)sysconf(_SC_PAGESIZE);
+		#endif // _WIN32
+		}
+
+		inline void Unmap()
+		{
+			if (Window == nullptr)
+			{
+				return;
+			}
+
+		#ifdef _WIN32
+			UnmapViewOfFile(Window);
+			CloseHandle(Mapping);
+			Mapping = nullptr;
+		#else
+			munmap(Window, WindowSize);
+		#endif // _WIN32
+			Window = nullptr;
+		}
+
+		/// <summary>
+		/// Grows the file and maps the window starting at offset. if it fails Window stays nullptr (the sink drops writes from then on)
+		/// and WindowStart/WindowPosition keep counting what was written, so the destructor still cuts the file back right
+		/// </summary>
+		inline void Map(const uint64_t& offset)
+		{
+			Unmap();
+
+			uint64_t granularity = Granularity();
+			uint64_t windowStart = offset - offset % granularity;
+			uint64_t fileSize = windowStart + WindowSize;
+
+		#ifdef _WIN32
+			Mapping = CreateFileMappingW(File, nullptr, PAGE_READWRITE, (DWORD)(fileSize >> 32), (DWORD)fileSize, nullptr); /* grows the file */
+			if (Mapping != nullptr)
+			{
+				Window = (char*)MapViewOfFile(Mapping, FILE_MAP_WRITE, (DWORD)(windowStart >> 32), (DWORD)windowStart, WindowSize);
+			}
+		#else
+			if (ftruncate(File, (off_t)fileSize) == 0)
+			{
+				void* mapping = mmap(nullptr, WindowSize, PROT_READ | PROT_WRITE, MAP_SHARED, File, (off_t)windowStart);
+				Window = (mapping == MAP_FAILED ? nullptr : (char*)mapping);
+			}
+		#endif // _WIN32
+
+			if (Window == nullptr)
+			{
+			#ifdef _WIN32
+				if (Mapping != nullptr)
+				{
+					CloseHandle(Mapping);
+					Mapping = nullptr;
+				}
+			#endif // _WIN32
+				throw std::runtime_error("Failed to map log file");
+			}
+
+			WindowStart = windowStart;
+			WindowPosition = (size_t)(offset - windowStart);
+		}
+
+	public:
+		/// <summary>
+		/// Opens (or continues) the log file
+		/// </summary>
+		/// <param name="path">- file to write to</param>
+		/// <param name="windowSize">(default = 16MB) - how much of the file is mapped at once, rounded up to the mapping granularity</param>
+		inline MappedFileLogSink(const std::filesystem::path& path, const size_t& windowSize = 16 * 1024 * 1024)
+		{
+			uint64_t granularity = Granularity();
+			WindowSize = (size_t)(((windowSize == 0 ? 1 : windowSize) + granularity - 1) / granularity * granularity);
+
+			uint64_t existingBytes = 0;
+		#ifdef _WIN32
+			File = CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+			LARGE_INTEGER fileSize;
+			if (File == INVALID_HANDLE_VALUE || !GetFileSizeEx(File, &fileSize))
+			{
+				throw std::runtime_error("Failed to open log file");
+			}
+			existingBytes = (uint64_t)fileSize.QuadPart;
+		#else
+			File = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+			struct stat fileStatus;
+			if (File == -1 || fstat(File, &fileStatus) != 0)
+			{
+				throw std::runtime_error("Failed to open log file");
+			}
+			existingBytes = (uint64_t)fileStatus.st_size;
+		#endif // _WIN32
+
+			try
+			{
+				Map(existingBytes);
+			}
+			catch (...)
+			{
+			#ifdef _WIN32
+				CloseHandle(File);
+			#else
+				close(File);
+			#endif // _WIN32
+				throw;
+			}
+		}
+
+		MappedFileLogSink(const MappedFileLogSink&) = delete;
+		MappedFileLogSink& operator=(const MappedFileLogSink&) = delete;
+
+		/* unmaps and cuts the file back to what was written */
+		inline ~MappedFileLogSink()
+		{
+			uint64_t writtenBytes = WindowStart + WindowPosition;
+			Unmap();
+
+		#ifdef _WIN32
+			LARGE_INTEGER end;
+			end.QuadPart = (LONGLONG)writtenBytes;
+			SetFilePointerEx(File, end, nullptr, FILE_BEGIN);
+			SetEndOfFile(File);
+			CloseHandle(File);
+		#else
+			if (ftruncate(File, (off_t)writtenBytes) != 0) {}
+			close(File);
+		#endif // _WIN32
+		}
+
+		/* throws if the next window can't be mapped, after that writes get dropped (see HasFailed) */
+		inline void Write(const std::string_view& line) override
+		{
+			size_t written = 0;
+			while (written < line.size())
+			{
+				if (Window == nullptr)
+				{
+					return;
+				}
+				if (WindowPosition == WindowSize)
+				{
+					Map(WindowStart + WindowSize);
+				}
+
+				size_t chunk = line.size() - written;
+				chunk = (chunk < WindowSize - WindowPosition ? chunk : WindowSize - WindowPosition);
+				std::memcpy(Window + WindowPosition, line.data() + written, chunk);
+				WindowPosition += chunk;
+				written += chunk;
+			}
+		}
+
+		/* asks the OS to start writing dirty pages back, doesn't wait for it */
+		inline void Flush() override
+		{
+			if (Window == nullptr)
+			{
+				return;
+			}
+
+		#ifdef _WIN32
+			FlushViewOfFile(Window, WindowPosition);
+		#else
+			uint64_t pageSize = Granularity();
+			msync(Window, (WindowPosition + pageSize - 1) / pageSize * pageSize, MS_ASYNC);
+		#endif // _WIN32
+		}
+
+		/// <summary>
+		/// bytes written to the file, including what it had when opened
+		/// </summary>
+		inline uint64_t GetSize() const
+		{
+			return WindowStart + WindowPosition;
+		}
+
+		/// <summary>
+		/// if mapping the next window failed, writes get dropped from then on
+		/// </summary>
+		inline bool HasFailed() const
+		{
+			return Window == nullptr;
+		}
+	};
+}
+
+#endif /* _SINKS_NOSLIB_HPP_ */
@@ -0,0 +1,636 @@
+#ifndef _PIPELINE_NOSLIB_HPP_
+#define _PIPELINE_NOSLIB_HPP_
+
+#include "ThreadPool.hpp"
+#include "ConcurrentQueue.hpp"
+
+#include <map>
+#include <optional>
+#include <memory>
+#include <vector>
+#include <functional>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <thread>
+#include <chrono>
+#include <cstdint>
+
+namespace NosLib
+{
+	template<class InputType>
+	class Pipeline;
+
+	template<class InputType, class CurrentType>
+	class PipelineBuilder;
+
+	template<class InputType>
+	PipelineBuilder<InputType, InputType> MakePipeline(ThreadPool* pool, const size_t& queueCapacity = 1024);
+
+	/// <summary>
+	/// namespace which contains the stages behind NosLib::Pipeline
+	/// </summary>
+	namespace PipelineStages
+	{
+		template<class Type>
+		struct IsOptional : std::false_type {};
+
+		template<class Type>
+		struct IsOptional<std::optional<Type>> : std::true_type {};
+
+		/// <summary>
+		/// what a stage passes on. functions returning std::optional act as filters, std::nullopt drops the item
+		/// </summary>
+		template<class ResultType>
+		struct StageOutput { using Type = ResultType; };
+
+		template<class ValueType>
+		struct StageOutput<std::optional<ValueType>> { using Type = ValueType; };
+
+		/// <summary>
+		/// placeholder output type of sinks
+		/// </summary>
+		struct NoOutput {};
+
+		/// <summary>
+		/// state shared by every stage of one pipeline
+		/// </summary>
+		class PipelineState
+		{
+		public:
+			ThreadPool* Pool;								/* pool the stages run on */
+			size_t QueueCapacity;							/* capacity of the queue in front of each stage */
+			std::atomic<uint64_t> NextSequence = 0;			/* sequence number of the next pushed item, used for ordered output */
+			std::atomic<int64_t> InFlight = 0;				/* items pushed which haven't reached the end yet */
+			std::atomic<int64_t> RunningDrainTasks = 0;		/* drain tasks submitted to the pool which haven't returned */
+			std::mutex CompletionMutex;						/* protects FirstException and the CV predicates */
+			std::condition_variable CompletionCV;
+			std::exception_ptr FirstException = nullptr;	/* first exception thrown by a stage, rethrown by Wait */
+
+			inline PipelineState(ThreadPool* pool, const size_t& queueCapacity)
+			{
+				Pool = pool;
+				QueueCapacity = queueCapacity;
+			}
+
+			/// <summary>
+			/// an item left the pipeline (reached the sink, got filtered out or threw)
+			/// </summary>
+			inline void FinishItem()
+			{
+				if (InFlight.fetch_sub(1) == 1)
+				{
+					std::lock_guard<std::mutex> lock(CompletionMutex);
+					CompletionCV.notify_all();
+				}
+			}
+
+			/* lock is held for the decrement, so the pipeline can't get destroyed before the task is done touching it */
+			inline void DrainTaskFinished()
+			{
+				std::lock_guard<std::mutex> lock(CompletionMutex);
+				if (RunningDrainTasks.fetch_sub(1) == 1)
+				{
+					CompletionCV.notify_all();
+				}
+			}
+
+			inline void RecordException(const std::exception_ptr& exception)
+			{
+				std::lock_guard<std::mutex> lock(CompletionMutex);
+				if (!FirstException)
+				{
+					FirstException = exception;
+				}
+			}
+		};
+
+		/// <summary>
+		/// type erased stage, lets the pipeline own and help every stage
+		/// </summary>
+		class StageBase
+		{
+		public:
+			virtual ~StageBase() = default;
+
+			/// <summary>
+			/// processes one queued item on the calling thread
+			/// </summary>
+			/// <returns>if an item was processed</returns>
+			virtual bool ProcessOne() = 0;
+		};
+
+		/// <summary>
+		/// anything which can take items of InputType
+		/// </summary>
+		template<class InputType>
+		class StageInput : public StageBase
+		{
+		public:
+			/// <summary>
+			/// Gives the stage an item. blocks (helping this stage) while its queue is full
+			/// </summary>
+			/// <param name="sequence">- sequence number of the item</param>
+			/// <param name="value">- the item</param>
+			virtual void Push(const uint64_t& sequence, InputType&& value) = 0;
+
+			/// <summary>
+			/// tells the stage sequence got dropped further up, so ordered output doesn't wait for it
+			/// </summary>
+			/// <param name="sequence">- sequence number of the dropped item</param>
+			virtual void Skip(const uint64_t& sequence) = 0;
+		};
+
+		/// <summary>
+		/// a stage with a bounded queue in front of it, drained by up to Parallelism pool tasks at once
+		/// </summary>
+		/// <typeparam name="InputType">- type the stage takes</typeparam>
+		/// <typeparam name="FunctionType">- the stage function</typeparam>
+		template<class InputType, class FunctionType>
+		class Stage : public StageInput<InputType>
+		{
+		public:
+			using ResultType = std::remove_cvref_t<std::invoke_result_t<FunctionType&, InputType&&>>;
+			using OutputType = typename StageOutput<ResultType>::Type;
+			using NextInputType = std::conditional_t<std::is_void_v<ResultType>, NoOutput, OutputType>;
+
+			StageInput<NextInputType>* Next = nullptr;		/* stage the results go to, nullptr for sinks */
+
+		protected:
+			/// <summary>
+			/// queued item, optional so the input type doesn't have to be default constructible
+			/// </summary>
+			struct QueuedItem
+			{
+				uint64_t Sequence = 0;
+				std::optional<InputType> Value;
+			};
+
+			PipelineState* State;
+			FunctionType Function;
+			unsigned int Parallelism;
+			NosLib::MPMCQueue<QueuedItem> Queue;
+			std::atomic<unsigned int> ActiveDrainers = 0;	/* drain tasks currently looping over the queue */
+
+			inline void Process(const uint64_t& sequence, InputType&& value)
+			{
+				if constexpr (std::is_void_v<ResultType>)
+				{
+					try
+					{
+						Function(std::move(value));
+					}
+					catch (...)
+					{
+						State->RecordException(std::current_exception());
+					}
+					State->FinishItem();
+				}
+				else
+				{
+					std::optional<ResultType> result;
+					try
+					{
+						result.emplace(Function(std::move(value)));
+					}
+					catch (...)
+					{
+						State->RecordException(std::current_exception());
+					}
+
+					if constexpr (IsOptional<ResultType>::value)
+					{
+						if (!result || !*result)
+						{
+							Next->Skip(sequence);
+							return;
+						}
+						Next->Push(sequence, std::move(**result));
+					}
+					else
+					{
+						if (!result)
+						{
+							Next->Skip(sequence);
+							return;
+						}
+						Next->Push(sequence, std::move(*result));
+					}
+				}
+			}
+
+			/// <summary>
+			/// submits another drain task if the stage is below its parallelism
+			/// </summary>
+			inline void ScheduleDrainer()
+			{
+				unsigned int activeDrainers = ActiveDrainers.load();
+				while (activeDrainers < Parallelism)
+				{
+					if (ActiveDrainers.compare_exchange_weak(activeDrainers, activeDrainers + 1))
+					{
+						State->RunningDrainTasks.fetch_add(1);
+						State->Pool->Submit([this]() { DrainLoop(); });
+						return;
+					}
+				}
+			}
+
+			inline void DrainLoop()
+			{
+				while (true)
+				{
+					while (ProcessOne()) {}
+
+					ActiveDrainers.fetch_sub(1);
+					std::atomic_thread_fence(std::memory_order_seq_cst); /* pairs with the fence in Push, either we see the new item or the pusher sees us gone */
+
+					/* an item could have been pushed after the last pop, while the pusher still counted us as draining */
+					unsigned int activeDrainers = ActiveDrainers.load();
+					if (Queue.Empty() || activeDrainers >= Parallelism || !ActiveDrainers.compare_exchange_strong(activeDrainers, activeDrainers + 1))
+					{
+						break;
+					}
+				}
+
+				State->DrainTaskFinished();
+			}
+
+		public:
+			inline Stage(PipelineState* state, FunctionType&& function, const unsigned int& parallelism)
+				: State(state), Function(std::move(function)), Parallelism(parallelism > 0 ? parallelism : 1), Queue(state->QueueCapacity) {}
+
+			inline void Push(const uint64_t& sequence, InputType&& value) override
+			{
+				QueuedItem item;
+				item.Sequence = sequence;
+				item.Value.emplace(std::move(value));
+
+				while (!Queue.TryPush(std::move(item)))
+				{
+					/* full, backpressure. help drain this stage instead of piling up more work */
+					if (!ProcessOne())
+					{
+						std::this_thread::yield();
+					}
+				}
+
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				ScheduleDrainer();
+			}
+
+			inline void Skip(const uint64_t& sequence) override
+			{
+				if constexpr (std::is_void_v<ResultType>)
+				{
+					State->FinishItem();
+				}
+				else
+				{
+					Next->Skip(sequence);
+				}
+			}
+
+			inline bool ProcessOne() override
+			{
+				QueuedItem item;
+				if (!Queue.TryPop(item))
+				{
+					return false;
+				}
+
+				Process(item.Sequence, std::move(*item.Value));
+				return true;
+			}
+		};
+
+		/// <summary>
+		/// sink which hands items to the function in the order they were pushed, using a reorder buffer keyed by sequence number.
+		/// the function runs on whichever thread completes the next item in line, one call at a time
+		/// </summary>
+		/// <typeparam name="InputType">- type the sink takes</typeparam>
+		/// <typeparam name="FunctionType">- the sink function</typeparam>
+		template<class InputType, class FunctionType>
+		class OrderedSink : public StageInput<InputType>
+		{
+		protected:
+			PipelineState* State;
+			FunctionType Function;
+			std::mutex ReorderMutex;									/* protects everything below and serializes Function */
+			std::map<uint64_t, std::optional<InputType>> Waiting;		/* items which arrived before the ones in front of them, nullopt for dropped items */
+			uint64_t NextSequence = 0;									/* sequence number the sink is waiting for */
+
+			inline void Deliver(std::optional<InputType>& value)
+			{
+				if (value)
+				{
+					try
+					{
+						Function(std::move(*value));
+					}
+					catch (...)
+					{
+						State->RecordException(std::current_exception());
+					}
+				}
+
+				NextSequence++;
+				State->FinishItem();
+			}
+
+			inline void Arrive(const uint64_t& sequence, std::optional<InputType>&& value)
+			{
+				std::lock_guard<std::mutex> lock(ReorderMutex);
+
+				if (sequence != NextSequence)
+				{
+					Waiting.emplace(sequence, std::move(value));
+					return;
+				}
+
+				Deliver(value);
+				while (!Waiting.empty() && Waiting.begin()->first == NextSequence)
+				{
+					auto node = Waiting.extract(Waiting.begin());
+					Deliver(node.mapped());
+				}
+			}
+
+		public:
+			inline OrderedSink(PipelineState* state, FunctionType&& function)
+				: State(state), Function(std::move(function)) {}
+
+			inline void Push(const uint64_t& sequence, InputType&& value) override
+			{
+				Arrive(sequence, std::optional<InputType>(std::move(value)));
+			}
+
+			inline void Skip(const uint64_t& sequence) override
+			{
+				Arrive(sequence, std::nullopt);
+			}
+
+			inline bool ProcessOne() override
+			{
+				return false; /* nothing queued, items get handled as they arrive */
+			}
+		};
+	}
+
+	/// <summary>
+	/// A finished pipeline. items pushed in flow through every stage on the pool, stages run in parallel with each other
+	/// and each stage runs up to its own parallelism at once
+	/// </summary>
+	/// <typeparam name="InputType">- type pushed into the first stage</typeparam>
+	template<class InputType>
+	class Pipeline
+	{
+		template<class, class>
+		friend class PipelineBuilder;
+
+	protected:
+		std::unique_ptr<PipelineStages::PipelineState> State;
+		std::vector<std::unique_ptr<PipelineStages::StageBase>> Stages;
+		PipelineStages::StageInput<InputType>* Head = nullptr;
+
+		inline Pipeline(std::unique_ptr<PipelineStages::PipelineState>&& state, std::vector<std::unique_ptr<PipelineStages::StageBase>>&& stages, PipelineStages::StageInput<InputType>* head)
+			: State(std::move(state)), Stages(std::move(stages)), Head(head) {}
+
+		/// <summary>
+		/// waits for every pushed item, helping the stages on the calling thread in the meantime
+		/// </summary>
+		/// <param name="deadline">- when to give up (nullptr to never give up)</param>
+		/// <returns>if every item made it through</returns>
+		inline bool WaitUntil(const std::chrono::steady_clock::time_point* deadline)
+		{
+			auto finished = [this]() { return State->InFlight.load() == 0; };
+
+			while (!finished())
+			{
+				if (deadline != nullptr && std::chrono::steady_clock::now() >= *deadline)
+				{
+					return false;
+				}
+
+				bool helped = false;
+				for (std::unique_ptr<PipelineStages::StageBase>& stage : Stages)
+				{
+					if (stage->ProcessOne())
+					{
+						helped = true;
+						break;
+					}
+				}
+
+				if (!helped)
+				{
+					std::unique_lock<std::mutex> lock(State->CompletionMutex);
+					State->CompletionCV.wait_for(lock, std::chrono::microseconds(100), finished);
+				}
+			}
+
+			return true;
+		}
+
+		inline void RethrowException()
+		{
+			std::exception_ptr exception;
+			{
+				std::lock_guard<std::mutex> lock(State->CompletionMutex);
+				exception = State->FirstException;
+				State->FirstException = nullptr;
+			}
+
+			if (exception)
+			{
+				std::rethrow_exception(exception);
+			}
+		}
+
+	public:
+		Pipeline(const Pipeline&) = delete;
+		Pipeline& operator=(const Pipeline&) = delete;
+		Pipeline(Pipeline&&) = default;
+
+		/* waits for items left and for every drain task to return, exceptions get dropped */
+		inline ~Pipeline()
+		{
+			if (State == nullptr)
+			{
+				return;
+			}
+
+			WaitUntil(nullptr);
+
+			std::unique_lock<std::mutex> lock(State->CompletionMutex);
+			State->CompletionCV.wait(lock, [this]() { return State->RunningDrainTasks.load() == 0; });
+		}
+
+		/// <summary>
+		/// Pushes an item into the first stage. blocks (helping the stage) while the stage's queue is full. can be called from multiple threads
+		/// </summary>
+		/// <param name="value">- the item</param>
+		inline void Push(InputType value)
+		{
+			State->InFlight.fetch_add(1);
+			Head->Push(State->NextSequence.fetch_add(1), std::move(value));
+		}
+
+		/// <summary>
+		/// Waits until every pushed item has made it through, rethrows the first exception a stage threw
+		/// </summary>
+		inline void Wait()
+		{
+			WaitUntil(nullptr);
+			RethrowException();
+		}
+
+		/// <summary>
+		/// Waits until every pushed item has made it through or the timeout runs out
+		/// </summary>
+		/// <param name="timeout">- longest time to wait</param>
+		/// <returns>true if everything made it through, false if it timed out</returns>
+		template<class Rep, class Period>
+		inline bool WaitFor(const std::chrono::duration<Rep, Period>& timeout)
+		{
+			std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + timeout;
+			if (!WaitUntil(&deadline))
+			{
+				return false;
+			}
+
+			RethrowException();
+			return true;
+		}
+
+		/// <summary>
+		/// amount of items pushed which haven't made it through yet
+		/// </summary>
+		/// <returns>in flight count</returns>
+		inline int64_t GetInFlightCount() const
+		{
+			return State->InFlight.load();
+		}
+	};
+
+	/// <summary>
+	/// Builds a pipeline stage by stage, started with NosLib::MakePipeline
+	/// </summary>
+	/// <typeparam name="InputType">- type pushed into the first stage</typeparam>
+	/// <typeparam name="CurrentType">- type the last added stage outputs</typeparam>
+	template<class InputType, class CurrentType>
+	class PipelineBuilder
+	{
+		template<class, class>
+		friend class PipelineBuilder;
+
+		template<class Type>
+		friend PipelineBuilder<Type, Type> MakePipeline(ThreadPool* pool, const size_t& queueCapacity);
+
+	protected:
+		std::unique_ptr<PipelineStages::PipelineState> State;
+		std::vector<std::unique_ptr<PipelineStages::StageBase>> Stages;
+		PipelineStages::StageInput<InputType>* Head = nullptr;
+		std::function<void(PipelineStages::StageInput<CurrentType>*)> Attach;	/* connects the last stage to the next one, empty before the first stage */
+
+		inline PipelineBuilder(std::unique_ptr<PipelineStages::PipelineState>&& state)
+			: State(std::move(state)) {}
+
+		inline PipelineBuilder(std::unique_ptr<PipelineStages::PipelineState>&& state, std::vector<std::unique_ptr<PipelineStages::StageBase>>&& stages,
+							   PipelineStages::StageInput<InputType>* head, std::function<void(PipelineStages::StageInput<CurrentType>*)>&& attach)
+			: State(std::move(state)), Stages(std::move(stages)), Head(head), Attach(std::move(attach)) {}
+
+		/// <summary>
+		/// hooks stage up as the next stage
+		/// </summary>
+		inline void Connect(PipelineStages::StageInput<CurrentType>* stage)
+		{
+			if (Attach)
+			{
+				Attach(stage);
+			}
+			else if constexpr (std::is_same_v<InputType, CurrentType>) /* first stage */
+			{
+				Head = stage;
+			}
+		}
+
+	public:
+		/// <summary>
+		/// Adds a stage. function takes the previous stage's output and returns this stage's output,
+		/// returning std::optional makes it a filter (std::nullopt drops the item)
+		/// </summary>
+		/// <typeparam name="Callable">- function(CurrentType) returning the next type</typeparam>
+		/// <param name="function">- the stage function</param>
+		/// <param name="parallelism">(default = 1) - most items the stage processes at once</param>
+		/// <returns>builder for the next stage</returns>
+		template<class Callable>
+		inline auto Then(Callable&& function, const unsigned int& parallelism = 1) &&
+		{
+			using StageType = PipelineStages::Stage<CurrentType, std::decay_t<Callable>>;
+			using OutputType = typename StageType::OutputType;
+			static_assert(!std::is_void_v<typename StageType::ResultType>, "Pipeline stages have to return a value, use Sink for the last stage");
+
+			std::unique_ptr<StageType> stage = std::make_unique<StageType>(State.get(), std::decay_t<Callable>(std::forward<Callable>(function)), parallelism);
+			StageType* rawStage = stage.get();
+			Connect(rawStage);
+			Stages.push_back(std::move(stage));
+
+			return PipelineBuilder<InputType, OutputType>(std::move(State), std::move(Stages), Head,
+														   [rawStage](PipelineStages::StageInput<OutputType>* next) { rawStage->Next = next; });
+		}
+
+		/// <summary>
+		/// Adds the final stage and finishes the pipeline
+		/// </summary>
+		/// <typeparam name="Callable">- function(CurrentType) returning void</typeparam>
+		/// <param name="function">- the sink function</param>
+		/// <param name="ordered">(default = false) - if items have to reach the sink in the order they were pushed (sink then runs one item at a time)</param>
+		/// <param name="parallelism">(default = 1) - most items the sink processes at once (ignored when ordered)</param>
+		/// <returns>the finished pipeline</returns>
+		template<class Callable>
+		inline Pipeline<InputType> Sink(Callable&& function, const bool& ordered = false, const unsigned int& parallelism = 1) &&
+		{
+			static_assert(std::is_void_v<std::invoke_result_t<std::decay_t<Callable>&, CurrentType&&>>, "Pipeline sink has to return void");
+
+			std::unique_ptr<PipelineStages::StageInput<CurrentType>> sink;
+			if (ordered)
+			{
+				sink = std::make_unique<PipelineStages::OrderedSink<CurrentType, std::decay_t<Callable>>>(State.get(), std::decay_t<Callable>(std::forward<Callable>(function)));
+			}
+			else
+			{
+				sink = std::make_unique<PipelineStages::Stage<CurrentType, std::decay_t<Callable>>>(State.get(), std::decay_t<Callable>(std::forward<Callable>(function)), parallelism);
+			}
+
+			Connect(sink.get());
+			Stages.push_back(std::move(sink));
+			return Pipeline<InputType>(std::move(State), std::move(Stages), Head);
+		}
+	};
+
+	/// <summary>
+	/// Starts building a pipeline which runs on pool, for example
+	/// NosLib::MakePipeline&lt;std::string&gt;(&amp;pool).Then(parse, 4).Then(transform, 8).Sink(write, true)
+	/// </summary>
+	/// <typeparam name="InputType">- type pushed into the first stage</typeparam>
+	/// <param name="pool">- pool the stages run on (needs started workers)</param>
+	/// <param name="queueCapacity">(default = 1024) - capacity of the bounded queue in front of each stage</param>
+	/// <returns>builder for the first stage</returns>
+	template<class InputType>
+	inline PipelineBuilder<InputType, InputType> MakePipeline(ThreadPool* pool, const size_t& queueCapacity)
+	{
+		if (pool->GetMaxWorkerCount() == 0)
+		{
+			throw std::logic_error("Pipeline needs a ThreadPool with started workers");
+		}
+
+		return PipelineBuilder<InputType, InputType>(std::make_unique<PipelineStages::PipelineState>(pool, queueCapacity));
+	}
+}
+
+#endif /* _PIPELINE_NOSLIB_HPP_ */
@@ -4,14 +4,21 @@
 #include "DynamicArray.hpp"
 #include "TypeTraits.hpp"
 #include "Cast.hpp"
+#include "String/Utf.hpp"
+#include "String/Search.hpp"
+#include "String/AhoCorasick.hpp"
+#include "String/Number.hpp"
 
 #ifdef _WIN32
 #include <Windows.h>
 #endif // _WIN32
 
 #include <string>
+#include <string_view>
 #include <sstream>
 #include <iterator>
+#include <algorithm>
+#include <utility>
 #include <cstdint>
 
 namespace NosLib
@@ -23,7 +30,9 @@ namespace NosLib
 	{
 #pragma region String Conversion
 		/// <summary>
-		/// Converts any string type to any other string type. template <ToType, FromType>
+		/// Converts any string type to any other string type. template <ToType, FromType>.
+		/// between char/char8_t (UTF-8), char16_t (UTF-16), char32_t (UTF-32) and wchar_t this properly transcodes and validates (see Utf::Transcode),
+		/// any other character type just gets each element cast. converting to the same type returns the string untouched
 		/// </summary>
 		/// <typeparam name="StringTo">- the string output type</typeparam>
 		/// <typeparam name="StringFrom">- the string input type</typeparam>
@@ -36,6 +45,10 @@ namespace NosLib
 			{
 				return strIn;
 			}
+			else if constexpr (Utf::IsUnicodeCharacter<StringTo> && Utf::IsUnicodeCharacter<StringFrom>)
+			{
+				return Utf::Transcode<StringTo>(strIn.data(), strIn.size());
+			}
 			else /* else, do standard conversion*/
 			{
 				std::basic_string<StringTo> strOut;
@@ -68,7 +81,7 @@ namespace NosLib
 
 #pragma region IsNumber
 		/// <summary>
-		/// Check if string is number (with or without signs)
+		/// Check if string is number (with or without signs). only validates, use ParseInt/ParseFloat to get the number out in the same pass
 		/// </summary>
 		/// <typeparam name="CharT">- string type</typeparam>
 		/// <param name="str">- string to check</param>
@@ -78,20 +91,21 @@ namespace NosLib
 		inline constexpr bool IsNumber(const std::basic_string<CharT>& str, const bool& allowSigns = true)
 		{
 			/* Iterator int, allows for changing start position */
-			int Iteration = 0;
-			if (allowSigns)
+			size_t Iteration = 0;
+			if (allowSigns && !str.empty() && (str[0] == (CharT)'-' || str[0] == (CharT)'+'))
 			{
-				/* if allowSigns is true, check if first character is either - or + or a number */
-				if ((str[0] != NosLib::String::ConvertCharacter<CharT, wchar_t>(L'-') && str[0] != NosLib::String::ConvertCharacter<CharT, wchar_t>(L'+')) && !std::isdigit(str[0]))
-					return false;
+				Iteration = 1; /* Make Iterator go up 1 so for loop doesn't check the sign */
+			}
 
-				Iteration = 1; /* Make Iterator go up 1 so for loop doesn't check first character */
+			if (Iteration == str.size()) /* empty, or just a sign */
+			{
+				return false;
 			}
 
 			/* Simple for loop, checking if any char isn't a digit */
 			for (; Iteration < str.size(); Iteration++)
 			{
-				if (!std::isdigit(str[Iteration])) return false;
+				if (!Number::IsDigit(str[Iteration])) return false;
 			}
 
 			return true;
@@ -99,29 +113,254 @@ namespace NosLib
 #pragma endregion
 
 #pragma region Split
+		/// <summary>
+		/// lazy range of the tokens of a string split by a delimiter (see SplitView). tokens are views into the input, so the input has to outlive them.
+		/// matches std::getline splitting: "a,,b" gives "a", "" and "b", a trailing delimiter doesn't give an empty last token
+		/// </summary>
+		/// <typeparam name="CharT">- string type</typeparam>
+		/// <typeparam name="DelimiterT">- a single CharT, a Search::CharacterSet (any of several characters) or a basic_string_view (a multi character separator)</typeparam>
+		template <typename CharT, typename DelimiterT = CharT>
+		class SplitRange
+		{
+		private:
+			std::basic_string_view<CharT> Input;
+			DelimiterT Delimiter;
+
+			/// <summary>
+			/// Finds the next delimiter
+			/// </summary>
+			/// <returns>position of the delimiter (NotFound if there isn't one) and how many characters it is</returns>
+			static inline constexpr std::pair<size_t, size_t> FindDelimiter(const DelimiterT& delimiter, const CharT* data, const size_t& length)
+			{
+				if constexpr (std::is_same_v<DelimiterT, Search::CharacterSet<CharT>>)
+				{
+					return {delimiter.FindFirst(data, length), 1};
+				}
+				else if constexpr (std::is_same_v<DelimiterT, std::basic_string_view<CharT>>)
+				{
+					if (delimiter.empty()) /* an empty separator splits nothing */
+					{
+						return {Search::NotFound, 0};
+					}
+					return {Search::FindSubstring(data, length, delimiter.data(), delimiter.size()), delimiter.size()};
+				}
+				else
+				{
+					return {Search::FindCharacter(data, length, delimiter), 1};
+				}
+			}
+
+		public:
+			class Iterator
+			{
+			private:
+				std::basic_string_view<CharT> Input;
+				const DelimiterT* Delimiter = nullptr;	/* the range's, so sets don't get copied with the iterator */
+				size_t Position = Search::NotFound;		/* start of the current token, NotFound once past the end */
+				size_t TokenEnd = 0;
+				size_t DelimiterLength = 0;
+
+				inline constexpr void FindTokenEnd()
+				{
+					if (Position >= Input.size()) /* nothing left (getline doesn't give a token after the last delimiter) */
+					{
+						Position = Search::NotFound;
+						return;
+					}
+
+					auto [found, delimiterLength] = FindDelimiter(*Delimiter, Input.data() + Position, Input.size() - Position);
+					TokenEnd = (found == Search::NotFound ? Input.size() : Position + found);
+					DelimiterLength = delimiterLength;
+				}
+
+			public:
+				using iterator_category = std::forward_iterator_tag;
+				using value_type = std::basic_string_view<CharT>;
+				using difference_type = std::ptrdiff_t;
+				using pointer = const value_type*;
+				using reference = value_type;
+
+				inline constexpr Iterator() = default;
+
+				inline constexpr Iterator(const std::basic_string_view<CharT>& input, const DelimiterT* delimiter)
+					: Input(input), Delimiter(delimiter), Position(0)
+				{
+					FindTokenEnd();
+				}
+
+				inline constexpr std::basic_string_view<CharT> operator*() const
+				{
+					return Input.substr(Position, TokenEnd - Position);
+				}
+
+				inline constexpr Iterator& operator++()
+				{
+					Position = TokenEnd + DelimiterLength;
+					FindTokenEnd();
+					return *this;
+				}
+
+				inline constexpr Iterator operator++(int)
+				{
+					Iterator previous = *this;
+					++(*this);
+					return previous;
+				}
+
+				inline constexpr bool operator==(const Iterator& other) const
+				{
+					return Position == other.Position;
+				}
+			};
+
+			inline constexpr SplitRange(const std::basic_string_view<CharT>& input, const DelimiterT& delimiter)
+				: Input(input), Delimiter(delimiter) {}
+
+			/* iterators point at the range's delimiter, so the range has to outlive them (it does in a range for) */
+			inline constexpr Iterator begin() const { return Iterator(Input, &Delimiter); }
+			inline constexpr Iterator end() const { return Iterator(); }
+		};
+
+		/// <summary>
+		/// Split a string into views of its tokens without copying or allocating, the delimiter gets found with a vectorized scan.
+		/// use like "for (std::string_view token : SplitView<char>(input, ','))"
+		/// </summary>
+		/// <typeparam name="CharT">- string type</typeparam>
+		/// <param name="input">- the input that will get split, has to outlive the tokens</param>
+		/// <param name="delimiter">(default = L' ') - delimiter which will determine the split</param>
+		/// <returns>lazy range of the tokens</returns>
+		template <typename CharT>
+		inline constexpr SplitRange<CharT> SplitView(const std::basic_string_view<CharT>& input, const CharT& delimiter = ' ')
+		{
+			return SplitRange<CharT>(input, delimiter);
+		}
+
+		/// <summary>
+		/// Split a string into views of its tokens, splitting on any character in a set (like Search::CharacterSet<char>(" \t\r\n,"))
+		/// </summary>
+		/// <typeparam name="CharT">- string type</typeparam>
+		/// <param name="input">- the input that will get split, has to outlive the tokens</param>
+		/// <param name="delimiters">- characters which will determine the split, make it once and reuse it</param>
+		/// <returns>lazy range of the tokens</returns>
+		template <typename CharT>
+		inline constexpr SplitRange<CharT, Search::CharacterSet<CharT>> SplitView(const std::basic_string_view<CharT>& input, const Search::CharacterSet<CharT>& delimiters)
+		{
+			return SplitRange<CharT, Search::CharacterSet<CharT>>(input, delimiters);
+		}
+
+		/// <summary>
+		/// Split a string into views of its tokens, splitting on a multi character separator (like ", " or "\r\n")
+		/// </summary>
+		/// <typeparam name="CharT">- string type</typeparam>
+		/// <param name="input">- the input that will get split, has to outlive the tokens</param>
+		/// <param name="separator">- string which will determine the split, has to outlive the range</param>
+		/// <returns>lazy range of the tokens</returns>
+		template <typename CharT>
+		inline constexpr SplitRange<CharT, std::basic_string_view<CharT>> SplitView(const std::basic_string_view<CharT>& input, const std::basic_string_view<CharT>& separator)
+		{
+			return SplitRange<CharT, std::basic_string_view<CharT>>(input, separator);
+		}
+
+		/// <summary>
+		/// Split a string into views of its tokens, putting them in a DynamicArray
+		/// </summary>
+		/// <typeparam name="CharT">- string type</typeparam>
+		/// <param name="result">- the DynamicArray that will get modified</param>
+		/// <param name="input">- the input that will get split, has to outlive the tokens</param>
+		/// <param name="delimiter">(default = L' ') - delimiter which will determine the split (a CharT, Search::CharacterSet or separator string)</param>
+		/// <returns>pointer to modified DynamicArray</returns>
+		template <typename CharT, typename DelimiterT = CharT>
+		inline constexpr NosLib::DynamicArray<std::basic_string_view<CharT>>* SplitView(NosLib::DynamicArray<std::basic_string_view<CharT>>* result, const std::basic_string_view<CharT>& input, const DelimiterT& delimiter = ' ')
+		{
+			for (const std::basic_string_view<CharT>& token : SplitView<CharT>(input, delimiter))
+			{
+				result->Append(token);
+			}
+
+			return result;
+		}
+
 		/// <summary>
 		/// Split a string into a DynamicArray Entries using a delimiter
 		/// </summary>
 		/// <typeparam name="CharT">- string type</typeparam>
 		/// <param name="result">- the DynamicArray that will get modified</param>
 		/// <param name="input">- the input that will get split</param>
-		/// <param name="delimiter">(default = L' ') - delimiter which will determine the split</param>
+		/// <param name="delimiter">(default = L' ') - delimiter which will determine the split (a CharT, Search::CharacterSet or separator string)</param>
 		/// <returns>pointer to modified DynamicArray</returns>
-		template <typename CharT>
-		inline constexpr NosLib::DynamicArray<std::basic_string<CharT>>* Split(NosLib::DynamicArray<std::basic_string<CharT>>* result, const std::basic_string<CharT>& input, const CharT& delimiter = ' ')
+		template <typename CharT, typename DelimiterT = CharT>
+		inline constexpr NosLib::DynamicArray<std::basic_string<CharT>>* Split(NosLib::DynamicArray<std::basic_string<CharT>>* result, const std::basic_string<CharT>& input, const DelimiterT& delimiter = ' ')
 		{
-			std::basic_string<CharT> tmp;
-			std::basic_stringstream<CharT> ss(input);
-
-			while (std::getline(ss, tmp, delimiter))
+			for (const std::basic_string_view<CharT>& token : SplitView<CharT>(input, delimiter))
 			{
-				result->Append(tmp);
+				result->Append(std::basic_string<CharT>(token));
 			}
 
 			return result;
 		}
 #pragma endregion
 
+#pragma region ParseColumn
+		/// <summary>
+		/// Parses one column of delimited text (like a CSV) into numbers, line by line. "\r\n" line ends are fine and empty lines get skipped.
+		/// fields are views and numbers go through ParseInt/ParseFloat, so nothing but the result gets allocated
+		/// </summary>
+		/// <typeparam name="NumberT">- integer or floating point type to get out</typeparam>
+		/// <typeparam name="CharT">- string type</typeparam>
+		/// <param name="result">- the DynamicArray the numbers get appended to</param>
+		/// <param name="text">- lines to parse</param>
+		/// <param name="column">- index of the field to parse in each line</param>
+		/// <param name="delimiter">(default = ',') - field delimiter (a CharT, Search::CharacterSet or separator string)</param>
+		/// <param name="failedLine">(default = nullptr) - gets set to the line number (from 1) parsing stopped at, if it failed</param>
+		/// <returns>std::errc() on success, otherwise the error of the field that failed (invalid_argument if a line doesn't have the column)</returns>
+		template <typename NumberT, typename CharT, typename DelimiterT = CharT>
+		inline std::errc ParseColumn(NosLib::DynamicArray<NumberT>* result, const std::basic_string_view<CharT>& text, const size_t& column, const DelimiterT& delimiter = ',', size_t* failedLine = nullptr)
+		{
+			size_t lineNumber = 0;
+			for (std::basic_string_view<CharT> line : SplitView<CharT>(text, (CharT)'\n'))
+			{
+				lineNumber++;
+				if (!line.empty() && line.back() == (CharT)'\r')
+				{
+					line.remove_suffix(1);
+				}
+				if (line.empty())
+				{
+					continue;
+				}
+
+				std::errc error = std::errc::invalid_argument; /* stays that way if the line runs out of fields first */
+				size_t fieldIndex = 0;
+				for (const std::basic_string_view<CharT>& field : SplitView<CharT>(line, delimiter))
+				{
+					if (fieldIndex++ != column)
+					{
+						continue;
+					}
+
+					NumberT value{};
+					error = ParseNumber<NumberT, CharT>(field, &value);
+					if (error == std::errc())
+					{
+						result->Append(value);
+					}
+					break;
+				}
+
+				if (error != std::errc())
+				{
+					if (failedLine != nullptr)
+					{
+						*failedLine = lineNumber;
+					}
+					return error;
+				}
+			}
+
+			return std::errc();
+		}
+#pragma endregion
+
 #pragma region Split
 		/// <summary>
 		/// Split a string into a DynamicArray Entries using a seperator
@@ -136,6 +375,14 @@ namespace NosLib
 		{
 			std::basic_string<CharT> out;
 
+			/* size it all up first, so it only allocates once */
+			size_t totalLength = (inputArray->GetItemCount() > 1 ? inputArray->GetItemCount() - 1 : 0);
+			for (int i = 0; i <= inputArray->GetLastArrayIndex(); i++)
+			{
+				totalLength += (*inputArray)[i].size();
+			}
+			out.reserve(totalLength);
+
 			for (int i = 0; i <= inputArray->GetLastArrayIndex(); i++)
 			{
 				out.append((*inputArray)[i]);
@@ -332,21 +579,27 @@ namespace NosLib
 
 #pragma region SubstringContainCount
 		/// <summary>
-		/// Counts the amount of times a substring is contained inside another string
+		/// Counts the amount of times a substring is contained inside another string (matches don't overlap, "aa" is in "aaaa" twice).
+		/// uses Search::FindSubstring, for counting many substrings at once use Search::AhoCorasick
 		/// </summary>
 		/// <typeparam name="CharT">- string type template</typeparam>
 		/// <param name="string">- main string</param>
-		/// <param name="substring">- substring to be searched for</param>
+		/// <param name="substring">- substring to be searched for (an empty one is never counted)</param>
 		/// <returns>count of amount of times substring is in string</returns>
 		template <typename CharT>
 		inline constexpr int SubstringContainCount(const std::basic_string<CharT>& string, const std::basic_string<CharT>& substring)
 		{
+			if (substring.empty())
+			{
+				return 0;
+			}
+
 			int count = 0;
-			size_t pos = 0;
-			while ((pos = string.find(substring, pos)) != std::basic_string<CharT>::npos)
+			size_t pos = 0, found;
+			while ((found = Search::FindSubstring(string.data() + pos, string.size() - pos, substring.data(), substring.size())) != Search::NotFound)
 			{
 				count++;
-				pos += substring.length();
+				pos += found + substring.length();
 			}
 
 			return count;
@@ -411,6 +664,50 @@ namespace NosLib
 #pragma endregion
 #endif // _WIN32
 
+		/// <summary>
+		/// default whitespace for the trim and reduce functions (" \t")
+		/// </summary>
+		template <typename CharT>
+		inline constexpr CharT DefaultWhitespace[] = {(CharT)' ', (CharT)'\t', (CharT)0};
+
+		/// <summary>
+		/// default fill for the reduce functions (" ")
+		/// </summary>
+		template <typename CharT>
+		inline constexpr CharT DefaultFill[] = {(CharT)' ', (CharT)0};
+
+		/// <summary>
+		/// removes whitespace characters either side of the string, without copying it
+		/// </summary>
+		/// <typeparam name="CharT">- string type template</typeparam>
+		/// <param name="string">- string to remove from</param>
+		/// <param name="whitespace">- whitespace characters</param>
+		/// <returns>view of the trimmed part of string</returns>
+		template <typename CharT>
+		inline constexpr std::basic_string_view<CharT> TrimView(const std::basic_string_view<CharT>& string, const Search::CharacterSet<CharT>& whitespace)
+		{
+			size_t strBegin = whitespace.FindFirstNot(string.data(), string.size());
+			if (strBegin == Search::NotFound)
+			{
+				return std::basic_string_view<CharT>(); // no content
+			}
+
+			return string.substr(strBegin, whitespace.FindLastNot(string.data(), string.size()) - strBegin + 1);
+		}
+
+		/// <summary>
+		/// removes whitespace characters either side of the string, without copying it
+		/// </summary>
+		/// <typeparam name="CharT">- string type template</typeparam>
+		/// <param name="string">- string to remove from</param>
+		/// <param name="whitespace">(default = " \t") - whitespace characters</param>
+		/// <returns>view of the trimmed part of string</returns>
+		template <typename CharT>
+		inline constexpr std::basic_string_view<CharT> TrimView(const std::basic_string_view<CharT>& string, const std::basic_string_view<CharT>& whitespace = DefaultWhitespace<CharT>)
+		{
+			return TrimView<CharT>(string, Search::CharacterSet<CharT>(whitespace));
+		}
+
 		/// <summary>
 		/// removes whitespace characters either side of the string
 		/// </summary>
@@ -421,13 +718,91 @@ namespace NosLib
 		template <typename CharT>
 		inline constexpr std::basic_string<CharT> Trim(const std::basic_string<CharT>& string, const std::basic_string<CharT>& whitespace = NosLib::String::ConvertString < CharT, char>(" \t"))
 		{
-			size_t strBegin = string.find_first_not_of(whitespace);
-			if (strBegin == std::basic_string<CharT>::npos)
+			return std::basic_string<CharT>(TrimView<CharT>(string, whitespace));
+		}
+
+		/// <summary>
+		/// Reduces all whitespaces to just 1 together and trims the ends, in one pass over the string. "  abc     edf " -> "abc edf".
+		/// with a fill of at most 1 character it all happens inside string, a longer fill can make the string grow so it gets built in a new buffer
+		/// </summary>
+		/// <typeparam name="CharT">- string type template</typeparam>
+		/// <param name="string">- string to reduce, gets modified</param>
+		/// <param name="fill">- what to replace whitespaces with</param>
+		/// <param name="whitespace">- whitespace characters</param>
+		/// <returns>reference to string</returns>
+		template <typename CharT>
+		inline constexpr std::basic_string<CharT>& ReduceInPlace(std::basic_string<CharT>& string, const std::basic_string_view<CharT>& fill, const Search::CharacterSet<CharT>& whitespace)
+		{
+			const size_t length = string.size();
+			size_t read = whitespace.FindFirstNot(string.data(), length);
+			if (read == Search::NotFound) /* only whitespace */
+			{
+				string.clear();
+				return string;
+			}
+
+			bool inPlace = (fill.size() <= 1); /* every run is at least 1 long, so writing never overtakes reading */
+			std::basic_string<CharT> built;
+			if (!inPlace)
+			{
+				built.reserve(length);
+			}
+
+			CharT* data = string.data();
+			size_t written = 0;
+			auto append = [&](const CharT* from, const size_t& count)
+				{
+					if (!inPlace)
+					{
+						built.append(from, count);
+						return;
+					}
+					if (data + written != from)
+					{
+						std::copy(from, from + count, data + written); /* moves left, so a forward copy is safe */
+					}
+					written += count;
+				};
+
+			while (true)
+			{
+				size_t wordLength = whitespace.FindFirst(data + read, length - read);
+				wordLength = (wordLength == Search::NotFound ? length - read : wordLength);
+				append(data + read, wordLength);
+				read += wordLength;
+
+				size_t spaceLength = (read == length ? Search::NotFound : whitespace.FindFirstNot(data + read, length - read));
+				if (spaceLength == Search::NotFound) /* end, or only whitespace left which gets trimmed */
+				{
+					break;
+				}
+				append(fill.data(), fill.size());
+				read += spaceLength;
+			}
+
+			if (inPlace)
 			{
-				return NosLib::String::ConvertString<CharT, wchar_t>(L""); // no content
+				string.resize(written);
 			}
+			else
+			{
+				string.swap(built);
+			}
+			return string;
+		}
 
-			return string.substr(strBegin, string.find_last_not_of(whitespace) - strBegin + 1);
+		/// <summary>
+		/// Reduces all whitespaces to just 1 together and trims the ends, in one pass over the string. "  abc     edf " -> "abc edf"
+		/// </summary>
+		/// <typeparam name="CharT">- string type template</typeparam>
+		/// <param name="string">- string to reduce, gets modified</param>
+		/// <param name="fill">(default = " ") - what to replace whitespaces with</param>
+		/// <param name="whitespace">(default = " \t") - whitespace characters</param>
+		/// <returns>reference to string</returns>
+		template <typename CharT>
+		inline constexpr std::basic_string<CharT>& ReduceInPlace(std::basic_string<CharT>& string, const std::basic_string_view<CharT>& fill = DefaultFill<CharT>, const std::basic_string_view<CharT>& whitespace = DefaultWhitespace<CharT>)
+		{
+			return ReduceInPlace<CharT>(string, fill, Search::CharacterSet<CharT>(whitespace));
 		}
 
 		/// <summary>
@@ -441,18 +816,8 @@ namespace NosLib
 		template <typename CharT>
 		inline constexpr std::basic_string<CharT> Reduce(const std::basic_string<CharT>& string, const std::basic_string<CharT>& fill = NosLib::String::ConvertString<CharT, char>(" "), const std::basic_string<CharT>& whitespace = NosLib::String::ConvertString < CharT, char>(" \t"))
 		{
-			// trim first
-			std::basic_string<CharT> result = Trim<CharT>(string, whitespace);
-
-			// replace sub ranges
-			size_t beginSpace = result.find_first_of(whitespace);
-			while (beginSpace != std::wstring::npos)
-			{
-				result.replace(beginSpace, result.find_first_not_of(whitespace, beginSpace) - beginSpace, fill);
-
-				beginSpace = result.find_first_of(whitespace, beginSpace + fill.length());
-			}
-
+			std::basic_string<CharT> result = string;
+			ReduceInPlace<CharT>(result, fill, whitespace);
 			return result;
 		}
 	}
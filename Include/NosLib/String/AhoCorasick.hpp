@@ -0,0 +1,264 @@
+#ifndef _AHOCORASICK_NOSLIB_HPP_
+#define _AHOCORASICK_NOSLIB_HPP_
+
+#include "Search.hpp"
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <initializer_list>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdint>
+#include <cstddef>
+
+namespace NosLib
+{
+	namespace String
+	{
+		namespace Search
+		{
+			/// <summary>
+			/// finds many needles in one pass over the text. the automaton is built once up front as a full transition table over the
+			/// characters the needles use (every other character is one class), so matching is one table lookup per character.
+			/// while nothing is partly matched it skips ahead to the next character a needle starts with using CharacterSet
+			/// </summary>
+			/// <typeparam name="CharT">- string type</typeparam>
+			template<typename CharT>
+			class AhoCorasick
+			{
+			private:
+				static constexpr uint32_t NoState = (uint32_t)-1;
+				static constexpr uint32_t MatchFlag = 0x80000000;	/* set on transitions into a state where a needle ends */
+
+				uint32_t ByteClass[256] = {};						/* character class of characters below 256, 0 = not in any needle */
+				std::unordered_map<CharT, uint32_t> WideClass;		/* character class of the rest */
+				uint32_t ClassCount = 1;
+
+				std::vector<uint32_t> Transitions;		/* state * ClassCount + class -> next state (as state * ClassCount, with MatchFlag) */
+				std::vector<uint32_t> Needle;			/* needle ending at a state, NoState if none */
+				std::vector<uint32_t> OutputLink;		/* closest state down the failure chain which ends a needle */
+				std::vector<size_t> NeedleLengths;
+
+				CharacterSet<CharT> FirstCharacters;	/* characters needles start with */
+				bool UseSkip = true;					/* skipping only pays off if the first characters aren't everywhere */
+
+				inline uint32_t ClassOf(const CharT& character) const
+				{
+					uint32_t unit = (uint32_t)(std::make_unsigned_t<CharT>)character;
+					if (unit < 256)
+					{
+						return ByteClass[unit];
+					}
+
+					auto found = WideClass.find(character);
+					return (found == WideClass.end() ? 0 : found->second);
+				}
+
+				static inline std::basic_string<CharT> CollectFirstCharacters(const std::vector<std::basic_string<CharT>>& needles)
+				{
+					std::basic_string<CharT> firstCharacters;
+					for (const std::basic_string<CharT>& needle : needles)
+					{
+						if (!needle.empty())
+						{
+							firstCharacters += needle[0];
+						}
+					}
+					return firstCharacters;
+				}
+
+				inline void Build(const std::vector<std::basic_string<CharT>>& needles)
+				{
+					for (const std::basic_string<CharT>& needle : needles)
+					{
+						NeedleLengths.push_back(needle.size());
+						for (const CharT& character : needle)
+						{
+							uint32_t unit = (uint32_t)(std::make_unsigned_t<CharT>)character;
+							if (unit < 256 ? ByteClass[unit] == 0 : WideClass.find(character) == WideClass.end())
+							{
+								(unit < 256 ? ByteClass[unit] : WideClass[character]) = ClassCount++;
+							}
+						}
+					}
+
+					/* trie, NoState where there's no edge yet */
+					Transitions.assign(ClassCount, NoState);
+					Needle.assign(1, NoState);
+					for (uint32_t needleIndex = 0; needleIndex < needles.size(); needleIndex++)
+					{
+						if (needles[needleIndex].empty()) /* an empty needle never matches */
+						{
+							continue;
+						}
+
+						uint32_t state = 0;
+						for (const CharT& character : needles[needleIndex])
+						{
+							uint32_t& next = Transitions[(size_t)state * ClassCount + ClassOf(character)];
+							if (next == NoState)
+							{
+								next = (uint32_t)Needle.size();
+								Needle.push_back(NoState);
+								Transitions.resize(Transitions.size() + ClassCount, NoState);
+							}
+							state = Transitions[(size_t)state * ClassCount + ClassOf(character)];
+						}
+						if (Needle[state] == NoState) /* duplicates count under the first one */
+						{
+							Needle[state] = needleIndex;
+						}
+					}
+
+					/* failure links breadth first, filling every missing edge with where the failure chain goes */
+					size_t stateCount = Needle.size();
+					std::vector<uint32_t> failure(stateCount, 0);
+					OutputLink.assign(stateCount, NoState);
+					std::vector<uint32_t> queue;
+					queue.reserve(stateCount);
+
+					for (uint32_t characterClass = 0; characterClass < ClassCount; characterClass++)
+					{
+						uint32_t& next = Transitions[characterClass];
+						if (next == NoState)
+						{
+							next = 0;
+						}
+						else
+						{
+							queue.push_back(next);
+						}
+					}
+
+					for (size_t head = 0; head < queue.size(); head++)
+					{
+						uint32_t state = queue[head];
+						uint32_t fallback = failure[state];
+						OutputLink[state] = (Needle[fallback] != NoState ? fallback : OutputLink[fallback]);
+
+						for (uint32_t characterClass = 0; characterClass < ClassCount; characterClass++)
+						{
+							uint32_t& next = Transitions[(size_t)state * ClassCount + characterClass];
+							uint32_t fallbackNext = Transitions[(size_t)fallback * ClassCount + characterClass];
+							if (next == NoState)
+							{
+								next = fallbackNext;
+							}
+							else
+							{
+								failure[next] = fallbackNext;
+								queue.push_back(next);
+							}
+						}
+					}
+
+					/* store the next state as its row offset with the match flag, so the matching loop is one load and one add per character */
+					if ((uint64_t)stateCount * ClassCount >= MatchFlag)
+					{
+						throw std::length_error("AhoCorasick: needles too big for the transition table");
+					}
+					for (uint32_t& next : Transitions)
+					{
+						bool ends = (Needle[next] != NoState || OutputLink[next] != NoState);
+						next = next * ClassCount | (ends ? MatchFlag : 0);
+					}
+
+					/* the skip is a vector scan for few distinct first characters, with many of them it'd stop on nearly every character */
+					std::basic_string<CharT> firstCharacters = CollectFirstCharacters(needles);
+					std::sort(firstCharacters.begin(), firstCharacters.end());
+					UseSkip = (std::unique(firstCharacters.begin(), firstCharacters.end()) - firstCharacters.begin() <= 8);
+				}
+
+			public:
+				/// <summary>
+				/// Builds the matcher
+				/// </summary>
+				/// <param name="needles">- what to look for, the index of each is what matches report (empty needles never match)</param>
+				inline AhoCorasick(const std::vector<std::basic_string<CharT>>& needles)
+					: FirstCharacters(CollectFirstCharacters(needles))
+				{
+					Build(needles);
+				}
+
+				inline AhoCorasick(const std::initializer_list<std::basic_string_view<CharT>>& needles)
+					: AhoCorasick(std::vector<std::basic_string<CharT>>(needles.begin(), needles.end())) {}
+
+				/// <summary>
+				/// Calls function(needleIndex, position) for every match, overlapping ones included. position is where the match starts
+				/// </summary>
+				/// <param name="text">- where to look</param>
+				/// <param name="function">- what to call per match</param>
+				template<typename Callable>
+				inline void ForEachMatch(const std::basic_string_view<CharT>& text, Callable&& function) const
+				{
+					const CharT* data = text.data();
+					const size_t length = text.size();
+					uint32_t row = 0;
+					size_t skipFrom = 0; /* skipping gets paused when it keeps stopping right away */
+
+					for (size_t position = 0; position < length; position++)
+					{
+						if (row == 0 && UseSkip && position >= skipFrom)
+						{
+							size_t skip = FirstCharacters.FindFirst(data + position, length - position);
+							if (skip == NotFound)
+							{
+								return;
+							}
+							if (skip < 16)
+							{
+								skipFrom = position + 64;
+							}
+							position += skip;
+						}
+
+						row = Transitions[row + ClassOf(data[position])];
+						if ((row & MatchFlag) == 0)
+						{
+							continue;
+						}
+
+						row &= ~MatchFlag;
+						uint32_t state = row / ClassCount;
+						for (uint32_t output = (Needle[state] != NoState ? state : OutputLink[state]); output != NoState; output = OutputLink[output])
+						{
+							uint32_t needleIndex = Needle[output];
+							function((size_t)needleIndex, position + 1 - NeedleLengths[needleIndex]);
+						}
+					}
+				}
+
+				/// <summary>
+				/// Counts every needle in one pass, overlapping matches included ("aa" is in "aaa" twice)
+				/// </summary>
+				/// <param name="text">- where to look</param>
+				/// <returns>count per needle, in the order they were given (duplicate needles count under the first one)</returns>
+				inline std::vector<size_t> Count(const std::basic_string_view<CharT>& text) const
+				{
+					std::vector<size_t> counts(NeedleLengths.size(), 0);
+					ForEachMatch(text, [&counts](const size_t& needleIndex, const size_t&) { counts[needleIndex]++; });
+					return counts;
+				}
+
+				/// <summary>
+				/// Counts matches of all needles together
+				/// </summary>
+				inline size_t CountAll(const std::basic_string_view<CharT>& text) const
+				{
+					size_t count = 0;
+					ForEachMatch(text, [&count](const size_t&, const size_t&) { count++; });
+					return count;
+				}
+
+				inline size_t GetNeedleCount() const
+				{
+					return NeedleLengths.size();
+				}
+			};
+		}
+	}
+}
+
+#endif /* _AHOCORASICK_NOSLIB_HPP_ */
@@ -0,0 +1,347 @@
+#ifndef _NUMBER_NOSLIB_HPP_
+#define _NUMBER_NOSLIB_HPP_
+
+#include <string>
+#include <string_view>
+#include <charconv>
+#include <system_error>
+#include <limits>
+#include <type_traits>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+
+namespace NosLib
+{
+	namespace String
+	{
+		/// <summary>
+		/// digit helpers for ParseInt and ParseFloat
+		/// </summary>
+		namespace Number
+		{
+			template<typename CharT>
+			inline constexpr bool IsDigit(const CharT& character)
+			{
+				return character >= (CharT)'0' && character <= (CharT)'9';
+			}
+
+			/// <summary>
+			/// if SWAR (8 digits in one 64 bit word) can be used on CharT
+			/// </summary>
+			template<typename CharT>
+			constexpr bool CanSwar = (sizeof(CharT) == 1 && std::endian::native == std::endian::little);
+
+			/// <summary>
+			/// Checks 8 characters at once
+			/// </summary>
+			/// <returns>true if all 8 are digits</returns>
+			inline bool AreEightDigits(const uint64_t& chunk)
+			{
+				/* top nibble has to be 3, adding 6 to the bottom nibble can't carry into it (so it was 0-9) */
+				return (((chunk & 0xF0F0F0F0F0F0F0F0) | (((chunk + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4)) == 0x3333333333333333);
+			}
+
+			/// <summary>
+			/// Converts 8 digit characters (first one most significant) with 3 multiplies instead of 8
+			/// </summary>
+			inline uint32_t ParseEightDigits(uint64_t chunk)
+			{
+				chunk -= 0x3030303030303030;
+				chunk = (chunk * 10) + (chunk >> 8); /* pairs of digits */
+				return (uint32_t)((((chunk & 0x000000FF000000FF) * (100 + (1000000ULL << 32))) + (((chunk >> 16) & 0x000000FF000000FF) * (1 + (10000ULL << 32)))) >> 32);
+			}
+
+			/// <summary>
+			/// Reads a run of digits into value, stopping at the first non digit or once 19 digits are read (so value can't overflow)
+			/// </summary>
+			/// <param name="position">- moved past the digits read</param>
+			/// <param name="value">- digits get added onto this</param>
+			/// <returns>digits read</returns>
+			template<typename CharT>
+			inline constexpr size_t ReadDigits(const CharT* data, const size_t& length, size_t& position, uint64_t& value, const size_t& maxDigits = 19)
+			{
+				size_t start = position;
+
+				if constexpr (CanSwar<CharT>)
+				{
+					if (!std::is_constant_evaluated())
+					{
+						while (position + 8 <= length && position - start + 8 <= maxDigits)
+						{
+							uint64_t chunk;
+							std::memcpy(&chunk, data + position, 8);
+							if (!AreEightDigits(chunk))
+							{
+								break;
+							}
+							value = value * 100000000 + ParseEightDigits(chunk);
+							position += 8;
+						}
+					}
+				}
+
+				while (position < length && position - start < maxDigits && IsDigit(data[position]))
+				{
+					value = value * 10 + (uint64_t)(data[position] - (CharT)'0');
+					position++;
+				}
+				return position - start;
+			}
+		}
+
+		/// <summary>
+		/// Validates and converts an integer in one pass, like std::from_chars but the whole string has to be the number.
+		/// takes an optional sign (a '-' only for signed types) and base 10 digits
+		/// </summary>
+		/// <typeparam name="IntT">- integer type to get out</typeparam>
+		/// <typeparam name="CharT">- string type</typeparam>
+		/// <param name="string">- string to parse</param>
+		/// <param name="value">- gets set to the number, left alone on error</param>
+		/// <returns>std::errc() on success, invalid_argument if it isn't a number, result_out_of_range if it doesn't fit IntT</returns>
+		template <typename IntT, typename CharT>
+		inline constexpr std::errc ParseInt(const std::basic_string_view<CharT>& string, IntT* value)
+		{
+			static_assert(std::is_integral_v<IntT> && !std::is_same_v<IntT, bool>, "ParseInt needs an integer type");
+
+			const CharT* data = string.data();
+			const size_t length = string.size();
+			size_t position = 0;
+
+			bool negative = false;
+			if (length != 0 && (data[0] == (CharT)'-' || data[0] == (CharT)'+'))
+			{
+				negative = (data[0] == (CharT)'-');
+				position++;
+			}
+			if (position == length || (negative && std::is_unsigned_v<IntT>))
+			{
+				return std::errc::invalid_argument;
+			}
+
+			while (position + 1 < length && data[position] == (CharT)'0') /* leading zeros don't count towards the 19 */
+			{
+				position++;
+			}
+
+			uint64_t magnitude = 0;
+			Number::ReadDigits(data, length, position, magnitude);
+			if (position < length) /* a 20th digit (still might fit in 64 bits) or something that isn't a digit */
+			{
+				if (!Number::IsDigit(data[position]))
+				{
+					return std::errc::invalid_argument;
+				}
+
+				uint64_t digit = (uint64_t)(data[position] - (CharT)'0');
+				bool overflow = (magnitude > (std::numeric_limits<uint64_t>::max() - digit) / 10);
+				magnitude = magnitude * 10 + digit;
+				position++;
+
+				for (; position < length; position++) /* anything past that is out of range, as long as it's digits */
+				{
+					if (!Number::IsDigit(data[position]))
+					{
+						return std::errc::invalid_argument;
+					}
+					overflow = true;
+				}
+				if (overflow)
+				{
+					return std::errc::result_out_of_range;
+				}
+			}
+
+			using UnsignedT = std::make_unsigned_t<IntT>;
+			uint64_t limit = (uint64_t)std::numeric_limits<IntT>::max() + (negative ? 1 : 0);
+			if (magnitude > limit)
+			{
+				return std::errc::result_out_of_range;
+			}
+
+			*value = (negative ? (IntT)(UnsignedT)(0 - (UnsignedT)magnitude) : (IntT)magnitude);
+			return std::errc();
+		}
+
+		/// <summary>
+		/// Validates and converts a floating point number in one pass, the whole string has to be the number.
+		/// takes an optional sign, digits with an optional '.', an optional exponent (e/E), plus "inf" and "nan".
+		/// common numbers (up to 19 significant digits and small exponents) are converted exactly right here, the rest goes to std::from_chars
+		/// </summary>
+		/// <typeparam name="FloatT">- float, double or long double</typeparam>
+		/// <typeparam name="CharT">- string type</typeparam>
+		/// <param name="string">- string to parse</param>
+		/// <param name="value">- gets set to the number, left alone on error</param>
+		/// <returns>std::errc() on success, invalid_argument if it isn't a number, result_out_of_range if it doesn't fit FloatT</returns>
+		template <typename FloatT, typename CharT>
+		inline std::errc ParseFloat(const std::basic_string_view<CharT>& string, FloatT* value)
+		{
+			static_assert(std::is_floating_point_v<FloatT>, "ParseFloat needs a floating point type");
+
+			const CharT* data = string.data();
+			const size_t length = string.size();
+			size_t position = 0;
+
+			bool negative = false;
+			if (length != 0 && (data[0] == (CharT)'-' || data[0] == (CharT)'+'))
+			{
+				negative = (data[0] == (CharT)'-');
+				position++;
+			}
+			size_t numberStart = position;
+
+			/* mantissa, only the first 19 significant digits fit, more than that goes to from_chars */
+			uint64_t mantissa = 0;
+			int64_t exponent = 0;
+			size_t significantDigits = 0;
+			bool truncated = false;
+
+			while (position < length && data[position] == (CharT)'0')
+			{
+				position++;
+			}
+			size_t integerDigits = Number::ReadDigits(data, length, position, mantissa);
+			significantDigits = integerDigits;
+			bool sawDigits = (integerDigits != 0 || position != numberStart);
+			if (position < length && Number::IsDigit(data[position]))
+			{
+				truncated = true;
+			}
+			while (position < length && Number::IsDigit(data[position])) /* integer digits past 19 */
+			{
+				exponent++;
+				position++;
+			}
+
+			if (position < length && data[position] == (CharT)'.')
+			{
+				position++;
+				size_t fractionStart = position;
+				if (significantDigits == 0) /* zeros straight after the point only move the exponent */
+				{
+					while (position < length && data[position] == (CharT)'0')
+					{
+						position++;
+					}
+					exponent -= (int64_t)(position - fractionStart);
+				}
+				if (!truncated)
+				{
+					size_t fractionDigits = Number::ReadDigits(data, length, position, mantissa, 19 - significantDigits);
+					significantDigits += fractionDigits;
+					exponent -= (int64_t)fractionDigits;
+				}
+				if (position < length && Number::IsDigit(data[position]))
+				{
+					truncated = true;
+				}
+				while (position < length && Number::IsDigit(data[position]))
+				{
+					position++;
+				}
+				sawDigits = sawDigits || position != fractionStart;
+			}
+
+			if (sawDigits && position < length && (data[position] == (CharT)'e' || data[position] == (CharT)'E'))
+			{
+				position++;
+				bool negativeExponent = false;
+				if (position < length && (data[position] == (CharT)'-' || data[position] == (CharT)'+'))
+				{
+					negativeExponent = (data[position] == (CharT)'-');
+					position++;
+				}
+
+				uint64_t writtenExponent = 0;
+				size_t exponentStart = position;
+				Number::ReadDigits(data, length, position, writtenExponent, 9);
+				if (position == exponentStart)
+				{
+					return std::errc::invalid_argument;
+				}
+				while (position < length && Number::IsDigit(data[position])) /* absurdly long exponents, from_chars sorts out the range */
+				{
+					truncated = true;
+					position++;
+				}
+				exponent += (negativeExponent ? -(int64_t)writtenExponent : (int64_t)writtenExponent);
+			}
+
+			if (sawDigits && position != length)
+			{
+				return std::errc::invalid_argument;
+			}
+
+			/* Clinger's fast path: the mantissa and the power of 10 are both exact in FloatT, so one multiply or divide rounds correctly */
+			constexpr int maxExactPower = (std::numeric_limits<FloatT>::digits >= 53 ? 22 : 10);
+			constexpr uint64_t maxExactMantissa = (uint64_t)1 << (std::numeric_limits<FloatT>::digits < 64 ? std::numeric_limits<FloatT>::digits : 63);
+			if (sawDigits && !truncated && mantissa <= maxExactMantissa && exponent >= -maxExactPower && exponent <= maxExactPower)
+			{
+				constexpr FloatT powers[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+											 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+				FloatT result = (FloatT)mantissa;
+				result = (exponent < 0 ? result / powers[-exponent] : result * powers[exponent]);
+				*value = (negative ? -result : result);
+				return std::errc();
+			}
+			if (sawDigits && mantissa == 0 && !truncated) /* zero with any exponent */
+			{
+				*value = (negative ? -(FloatT)0 : (FloatT)0);
+				return std::errc();
+			}
+
+			/* everything else (long mantissas, big exponents, inf, nan) */
+			if (numberStart < length && (data[numberStart] == (CharT)'-' || data[numberStart] == (CharT)'+')) /* from_chars would take a second '-' */
+			{
+				return std::errc::invalid_argument;
+			}
+
+			std::string narrow;
+			narrow.reserve(length - numberStart + 1);
+			if (negative)
+			{
+				narrow += '-';
+			}
+			for (size_t i = numberStart; i < length; i++)
+			{
+				uint32_t unit = (uint32_t)(std::make_unsigned_t<CharT>)data[i];
+				if (unit >= 0x80)
+				{
+					return std::errc::invalid_argument;
+				}
+				narrow += (char)unit;
+			}
+
+			FloatT result;
+			std::from_chars_result parsed = std::from_chars(narrow.data(), narrow.data() + narrow.size(), result);
+			if (parsed.ec != std::errc())
+			{
+				return parsed.ec;
+			}
+			if (parsed.ptr != narrow.data() + narrow.size())
+			{
+				return std::errc::invalid_argument;
+			}
+			*value = result;
+			return std::errc();
+		}
+
+		/// <summary>
+		/// ParseInt or ParseFloat depending on NumberT
+		/// </summary>
+		template <typename NumberT, typename CharT>
+		inline std::errc ParseNumber(const std::basic_string_view<CharT>& string, NumberT* value)
+		{
+			if constexpr (std::is_floating_point_v<NumberT>)
+			{
+				return ParseFloat<NumberT, CharT>(string, value);
+			}
+			else
+			{
+				return ParseInt<NumberT, CharT>(string, value);
+			}
+		}
+	}
+}
+
+#endif /* _NUMBER_NOSLIB_HPP_ */
@@ -0,0 +1,608 @@
+#ifndef _SEARCH_NOSLIB_HPP_
+#define _SEARCH_NOSLIB_HPP_
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <bit>
+#include <string>
+#include <string_view>
+
+#ifndef NOSLIB_STRING_SSE2
+#if defined(_M_X64) || defined(_M_AMD64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define NOSLIB_STRING_SSE2
+#endif
+#endif // NOSLIB_STRING_SSE2
+
+#if defined(NOSLIB_STRING_SSE2) && (defined(__SSSE3__) || defined(__AVX__))
+#include <tmmintrin.h>
+#define NOSLIB_STRING_SSSE3
+#endif
+
+namespace NosLib
+{
+	namespace String
+	{
+		/// <summary>
+		/// vectorized scanning used by the splitting and searching functions. works on raw pointers so strings and views can both use it
+		/// </summary>
+		namespace Search
+		{
+			constexpr size_t NotFound = (size_t)-1;
+
+		#ifdef NOSLIB_STRING_SSE2
+			template<typename CharT>
+			inline __m128i Broadcast(const CharT& character)
+			{
+				if constexpr (sizeof(CharT) == 1)
+				{
+					return _mm_set1_epi8((char)character);
+				}
+				else if constexpr (sizeof(CharT) == 2)
+				{
+					return _mm_set1_epi16((short)character);
+				}
+				else
+				{
+					return _mm_set1_epi32((int)character);
+				}
+			}
+
+			/// <summary>
+			/// bitmask of which units in the 16 bytes at data equal the broadcast character (2 bits per 16 bit unit, 4 per 32 bit unit)
+			/// </summary>
+			template<typename CharT>
+			inline int EqualMask(const CharT* data, const __m128i& character)
+			{
+				__m128i block = _mm_loadu_si128((const __m128i*)data);
+				if constexpr (sizeof(CharT) == 1)
+				{
+					return _mm_movemask_epi8(_mm_cmpeq_epi8(block, character));
+				}
+				else if constexpr (sizeof(CharT) == 2)
+				{
+					return _mm_movemask_epi8(_mm_cmpeq_epi16(block, character));
+				}
+				else
+				{
+					return _mm_movemask_epi8(_mm_cmpeq_epi32(block, character));
+				}
+			}
+		#endif // NOSLIB_STRING_SSE2
+
+			/// <summary>
+			/// Finds the first character in data (memchr for any character size)
+			/// </summary>
+			/// <param name="data">- where to look</param>
+			/// <param name="length">- amount of characters in data</param>
+			/// <param name="character">- character to look for</param>
+			/// <returns>position of the character, NotFound if it isn't there</returns>
+			template<typename CharT>
+			inline constexpr size_t FindCharacter(const CharT* data, const size_t& length, const CharT& character)
+			{
+				if (!std::is_constant_evaluated())
+				{
+					if constexpr (sizeof(CharT) == 1)
+					{
+						const void* found = (length != 0 ? std::memchr(data, (unsigned char)character, length) : nullptr);
+						return (found == nullptr ? NotFound : (size_t)((const CharT*)found - data));
+					}
+				#ifdef NOSLIB_STRING_SSE2
+					else if constexpr (sizeof(CharT) == 2 || sizeof(CharT) == 4)
+					{
+						constexpr size_t perBlock = 16 / sizeof(CharT);
+						__m128i broadcast = Broadcast(character);
+
+						size_t position = 0;
+						for (; position + perBlock * 2 <= length; position += perBlock * 2) /* 2 blocks per check, the OR keeps the common "no match" case to one branch */
+						{
+							int first = EqualMask(data + position, broadcast);
+							int second = EqualMask(data + position + perBlock, broadcast);
+							if ((first | second) != 0)
+							{
+								return (first != 0 ? position + std::countr_zero((unsigned int)first) / sizeof(CharT) : position + perBlock + std::countr_zero((unsigned int)second) / sizeof(CharT));
+							}
+						}
+						for (; position + perBlock <= length; position += perBlock)
+						{
+							int mask = EqualMask(data + position, broadcast);
+							if (mask != 0)
+							{
+								return position + std::countr_zero((unsigned int)mask) / sizeof(CharT);
+							}
+						}
+						for (; position < length; position++)
+						{
+							if (data[position] == character)
+							{
+								return position;
+							}
+						}
+						return NotFound;
+					}
+				#endif // NOSLIB_STRING_SSE2
+				}
+
+				for (size_t i = 0; i < length; i++)
+				{
+					if (data[i] == character)
+					{
+						return i;
+					}
+				}
+				return NotFound;
+			}
+
+			/// <summary>
+			/// Splits needle into a left and right half for the Two-Way search (Crochemore-Perrin critical factorization)
+			/// </summary>
+			/// <param name="period">- gets set to the period of the right half</param>
+			/// <returns>where the right half starts</returns>
+			template<typename CharT>
+			inline constexpr size_t CriticalFactorization(const CharT* needle, const size_t& needleLength, size_t* period)
+			{
+				/* maximal suffix by < then by >, NotFound + 1 wraps to 0 which the algorithm relies on */
+				size_t maxSuffix = NotFound, maxSuffixReverse = NotFound;
+				size_t j = 0, k = 1, p = 1;
+				while (j + k < needleLength)
+				{
+					CharT a = needle[j + k], b = needle[maxSuffix + k];
+					if (a < b)
+					{
+						j += k; k = 1; p = j - maxSuffix;
+					}
+					else if (a == b)
+					{
+						if (k != p) { k++; }
+						else { j += p; k = 1; }
+					}
+					else
+					{
+						maxSuffix = j++; k = p = 1;
+					}
+				}
+				*period = p;
+
+				j = 0; k = p = 1;
+				while (j + k < needleLength)
+				{
+					CharT a = needle[j + k], b = needle[maxSuffixReverse + k];
+					if (b < a)
+					{
+						j += k; k = 1; p = j - maxSuffixReverse;
+					}
+					else if (a == b)
+					{
+						if (k != p) { k++; }
+						else { j += p; k = 1; }
+					}
+					else
+					{
+						maxSuffixReverse = j++; k = p = 1;
+					}
+				}
+
+				if (maxSuffixReverse + 1 < maxSuffix + 1)
+				{
+					return maxSuffix + 1;
+				}
+				*period = p;
+				return maxSuffixReverse + 1;
+			}
+
+			/// <summary>
+			/// Two-Way search, linear time and constant space no matter the input. slower than the vector filter on normal text,
+			/// FindSubstring falls back to it when the filter keeps finding candidates that don't match
+			/// </summary>
+			/// <returns>position of needle, NotFound if it isn't there</returns>
+			template<typename CharT>
+			inline constexpr size_t TwoWayFind(const CharT* data, const size_t& length, const CharT* needle, const size_t& needleLength)
+			{
+				if (needleLength == 0)
+				{
+					return 0;
+				}
+				if (needleLength > length)
+				{
+					return NotFound;
+				}
+
+				size_t period = 0;
+				size_t suffix = CriticalFactorization(needle, needleLength, &period);
+
+				bool periodic = true;
+				for (size_t i = 0; i < suffix; i++)
+				{
+					if (needle[i] != needle[i + period])
+					{
+						periodic = false;
+						break;
+					}
+				}
+
+				size_t j = 0;
+				if (periodic) /* remembers how much of the right half already matched, so periodic needles like "aaab" stay linear */
+				{
+					size_t memory = 0;
+					while (j <= length - needleLength)
+					{
+						size_t i = (suffix > memory ? suffix : memory);
+						while (i < needleLength && needle[i] == data[i + j])
+						{
+							i++;
+						}
+						if (i < needleLength)
+						{
+							j += i - suffix + 1;
+							memory = 0;
+							continue;
+						}
+
+						i = suffix - 1;
+						while (memory < i + 1 && needle[i] == data[i + j])
+						{
+							i--;
+						}
+						if (i + 1 < memory + 1)
+						{
+							return j;
+						}
+						j += period;
+						memory = needleLength - period;
+					}
+				}
+				else
+				{
+					period = (suffix > needleLength - suffix ? suffix : needleLength - suffix) + 1;
+					while (j <= length - needleLength)
+					{
+						size_t i = suffix;
+						while (i < needleLength && needle[i] == data[i + j])
+						{
+							i++;
+						}
+						if (i < needleLength)
+						{
+							j += i - suffix + 1;
+							continue;
+						}
+
+						i = suffix - 1;
+						while (i != NotFound && needle[i] == data[i + j])
+						{
+							i--;
+						}
+						if (i == NotFound)
+						{
+							return j;
+						}
+						j += period;
+					}
+				}
+				return NotFound;
+			}
+
+			/// <summary>
+			/// Finds the first place needle is in data. candidates are found 32 bytes at a time by checking the first and last character
+			/// of needle together (which rules out nearly every position in normal text), then the middle gets compared.
+			/// if the candidates keep failing (text like "aaaa...") the rest is done with TwoWayFind, so it never goes quadratic
+			/// </summary>
+			/// <param name="data">- where to look</param>
+			/// <param name="length">- amount of characters in data</param>
+			/// <param name="needle">- what to look for</param>
+			/// <param name="needleLength">- amount of characters in needle</param>
+			/// <returns>position of needle, NotFound if it isn't there (0 for an empty needle)</returns>
+			template<typename CharT>
+			inline constexpr size_t FindSubstring(const CharT* data, const size_t& length, const CharT* needle, const size_t& needleLength)
+			{
+				if (needleLength == 0)
+				{
+					return 0;
+				}
+				if (needleLength > length)
+				{
+					return NotFound;
+				}
+				if (needleLength == 1)
+				{
+					return FindCharacter(data, length, needle[0]);
+				}
+
+				size_t position = 0;
+
+				if (!std::is_constant_evaluated())
+				{
+				#ifdef NOSLIB_STRING_SSE2
+					if constexpr (sizeof(CharT) == 1 || sizeof(CharT) == 2 || sizeof(CharT) == 4)
+					{
+						constexpr size_t perBlock = 16 / sizeof(CharT);
+						constexpr unsigned int unitBits = (1u << sizeof(CharT)) - 1;
+						size_t lastOffset = needleLength - 1;
+						__m128i first = Broadcast(needle[0]);
+						__m128i last = Broadcast(needle[lastOffset]);
+						size_t compared = 0; /* characters compared by failed candidates, once that outgrows what got scanned the filter isn't helping */
+
+						for (; position + lastOffset + perBlock * 2 <= length; position += perBlock * 2) /* 2 blocks per check, like FindCharacter */
+						{
+							unsigned int candidates = (unsigned int)(EqualMask(data + position, first) & EqualMask(data + position + lastOffset, last)) |
+													  ((unsigned int)(EqualMask(data + position + perBlock, first) & EqualMask(data + position + perBlock + lastOffset, last)) << 16);
+							if (candidates == 0)
+							{
+								continue;
+							}
+
+							if (compared > position + 4096)
+							{
+								break;
+							}
+							do
+							{
+								int bit = std::countr_zero(candidates);
+								size_t candidate = position + bit / sizeof(CharT);
+								if (std::memcmp(data + candidate + 1, needle + 1, (needleLength - 2) * sizeof(CharT)) == 0)
+								{
+									return candidate;
+								}
+								compared += needleLength;
+								candidates &= ~(unitBits << bit);
+							} while (candidates != 0);
+						}
+					}
+				#endif // NOSLIB_STRING_SSE2
+				}
+
+				size_t found = TwoWayFind(data + position, length - position, needle, needleLength);
+				return (found == NotFound ? NotFound : position + found);
+			}
+
+			/// <summary>
+			/// set of characters to look for all at once (like the delimiters " \t\r\n,").
+			/// bytes get matched 16 at a time, with a nibble lookup (pshufb) where SSSE3 is there or by comparing against each member
+			/// for small sets where only SSE2 is. wider characters get narrowed to bytes first. sets with characters above 0xFE use a plain loop
+			/// </summary>
+			/// <typeparam name="CharT">- string type</typeparam>
+			template<typename CharT>
+			class CharacterSet
+			{
+			private:
+				uint64_t Bitmap[4] = {};				/* members below 256 */
+				std::basic_string<CharT> WideMembers;	/* members from 256 up */
+				bool Vectorizable = true;				/* every member is below 0xFF, so narrowing (which saturates to 0xFF) can't cause false matches */
+
+				uint8_t LowTable[16] = {};		/* bit of each high nibble group a low nibble is in */
+				uint8_t HighTable[16] = {};		/* bit of the group for each high nibble */
+				bool NibbleExact = true;		/* only 8 groups fit, sets with more distinct high nibbles can't use the lookup */
+				uint8_t Members[8] = {};
+				int MemberCount = 0;
+
+			#ifdef NOSLIB_STRING_SSE2
+				/// <summary>
+				/// loads 16 characters as 16 bytes, anything above 0xFF becomes 0xFF
+				/// </summary>
+				static inline __m128i LoadNarrow(const CharT* data)
+				{
+					if constexpr (sizeof(CharT) == 1)
+					{
+						return _mm_loadu_si128((const __m128i*)data);
+					}
+					else if constexpr (sizeof(CharT) == 2)
+					{
+						return _mm_packus_epi16(_mm_loadu_si128((const __m128i*)data), _mm_loadu_si128((const __m128i*)(data + 8)));
+					}
+					else
+					{
+						/* clamp to 16 bits, then bias so the signed pack is exact */
+						const __m128i bias = _mm_set1_epi32(0x8000);
+						__m128i narrowed[4];
+						for (int i = 0; i < 4; i++)
+						{
+							__m128i part = _mm_loadu_si128((const __m128i*)(data + i * 4));
+							__m128i fits = _mm_cmpeq_epi32(_mm_srli_epi32(part, 16), _mm_setzero_si128());
+							part = _mm_or_si128(_mm_and_si128(fits, part), _mm_andnot_si128(fits, _mm_set1_epi32(0xFFFF)));
+							narrowed[i] = _mm_sub_epi32(part, bias);
+						}
+						const __m128i unbias = _mm_set1_epi16((short)0x8000);
+						__m128i low = _mm_add_epi16(_mm_packs_epi32(narrowed[0], narrowed[1]), unbias);
+						__m128i high = _mm_add_epi16(_mm_packs_epi32(narrowed[2], narrowed[3]), unbias);
+						return _mm_packus_epi16(low, high);
+					}
+				}
+
+				/// <summary>
+				/// bit per byte of which bytes are members
+				/// </summary>
+				inline int MatchMask(const __m128i& bytes) const
+				{
+				#ifdef NOSLIB_STRING_SSSE3
+					if (NibbleExact)
+					{
+						const __m128i nibbleMask = _mm_set1_epi8(0x0F);
+						__m128i lowNibbles = _mm_and_si128(bytes, nibbleMask);
+						__m128i highNibbles = _mm_and_si128(_mm_srli_epi16(bytes, 4), nibbleMask);
+						__m128i groups = _mm_and_si128(_mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)LowTable), lowNibbles),
+													   _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)HighTable), highNibbles));
+						return _mm_movemask_epi8(_mm_cmpeq_epi8(groups, _mm_setzero_si128())) ^ 0xFFFF;
+					}
+				#endif // NOSLIB_STRING_SSSE3
+
+					__m128i matches = _mm_setzero_si128();
+					for (int i = 0; i < MemberCount; i++)
+					{
+						matches = _mm_or_si128(matches, _mm_cmpeq_epi8(bytes, _mm_set1_epi8((char)Members[i])));
+					}
+					return _mm_movemask_epi8(matches);
+				}
+
+				/// <summary>
+				/// if the vector path is worth using with how this set got built
+				/// </summary>
+				inline bool UseVector() const
+				{
+				#ifdef NOSLIB_STRING_SSSE3
+					return Vectorizable && (NibbleExact || MemberCount <= 8);
+				#else
+					return Vectorizable && MemberCount <= 8;
+				#endif // NOSLIB_STRING_SSSE3
+				}
+			#endif // NOSLIB_STRING_SSE2
+
+			public:
+				/// <summary>
+				/// Makes a set
+				/// </summary>
+				/// <param name="characters">- the members (duplicates are fine)</param>
+				inline constexpr CharacterSet(const std::basic_string_view<CharT>& characters)
+				{
+					int highNibbleGroups = 0;
+					int highNibbleGroup[16] = {-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1};
+
+					for (const CharT& character : characters)
+					{
+						uint32_t unit = (uint32_t)(std::make_unsigned_t<CharT>)character;
+						if (unit >= 0xFF && sizeof(CharT) != 1)
+						{
+							Vectorizable = false;
+						}
+						if (unit > 0xFF)
+						{
+							if (WideMembers.find(character) == std::basic_string<CharT>::npos)
+							{
+								WideMembers += character;
+							}
+							continue;
+						}
+						if ((Bitmap[unit >> 6] >> (unit & 63)) & 1) /* duplicate */
+						{
+							continue;
+						}
+						Bitmap[unit >> 6] |= (uint64_t)1 << (unit & 63);
+
+						if (MemberCount < 8)
+						{
+							Members[MemberCount] = (uint8_t)unit;
+						}
+						MemberCount++;
+
+						int highNibble = (int)(unit >> 4);
+						if (highNibbleGroup[highNibble] == -1)
+						{
+							highNibbleGroup[highNibble] = highNibbleGroups++;
+						}
+						if (highNibbleGroup[highNibble] >= 8)
+						{
+							NibbleExact = false;
+							continue;
+						}
+
+						uint8_t groupBit = (uint8_t)(1 << highNibbleGroup[highNibble]);
+						HighTable[highNibble] = groupBit;
+						LowTable[unit & 0x0F] |= groupBit;
+					}
+				}
+
+				inline constexpr bool Contains(const CharT& character) const
+				{
+					uint32_t unit = (uint32_t)(std::make_unsigned_t<CharT>)character;
+					if (unit > 0xFF)
+					{
+						return WideMembers.find(character) != std::basic_string<CharT>::npos;
+					}
+					return (Bitmap[unit >> 6] >> (unit & 63)) & 1;
+				}
+
+				/// <summary>
+				/// Finds the first member in data
+				/// </summary>
+				/// <param name="data">- where to look</param>
+				/// <param name="length">- amount of characters in data</param>
+				/// <returns>position of the member, NotFound if there isn't any</returns>
+				inline constexpr size_t FindFirst(const CharT* data, const size_t& length) const
+				{
+					return FindFirstWhere<true>(data, length);
+				}
+
+				/// <summary>
+				/// Finds the first character in data which isn't a member
+				/// </summary>
+				/// <returns>position of the character, NotFound if everything is a member</returns>
+				inline constexpr size_t FindFirstNot(const CharT* data, const size_t& length) const
+				{
+					return FindFirstWhere<false>(data, length);
+				}
+
+				/// <summary>
+				/// Finds the last character in data which isn't a member
+				/// </summary>
+				/// <returns>position of the character, NotFound if everything is a member</returns>
+				inline constexpr size_t FindLastNot(const CharT* data, const size_t& length) const
+				{
+					size_t end = length;
+
+					if (!std::is_constant_evaluated())
+					{
+					#ifdef NOSLIB_STRING_SSE2
+						if (UseVector())
+						{
+							for (; end >= 16; end -= 16)
+							{
+								unsigned int mask = (unsigned int)MatchMask(LoadNarrow(data + end - 16)) ^ 0xFFFF;
+								if (mask != 0)
+								{
+									return end - 16 + (31 - std::countl_zero(mask));
+								}
+							}
+						}
+					#endif // NOSLIB_STRING_SSE2
+					}
+
+					while (end != 0)
+					{
+						end--;
+						if (!Contains(data[end]))
+						{
+							return end;
+						}
+					}
+					return NotFound;
+				}
+
+			private:
+				template<bool WantMembers> /* true finds the first member, false the first non member */
+				inline constexpr size_t FindFirstWhere(const CharT* data, const size_t& length) const
+				{
+					size_t position = 0;
+
+					if (!std::is_constant_evaluated())
+					{
+					#ifdef NOSLIB_STRING_SSE2
+						if (UseVector())
+						{
+							for (; position + 16 <= length; position += 16)
+							{
+								unsigned int mask = (unsigned int)MatchMask(LoadNarrow(data + position)) ^ (WantMembers ? 0 : 0xFFFF);
+								if (mask != 0)
+								{
+									return position + std::countr_zero(mask);
+								}
+							}
+						}
+					#endif // NOSLIB_STRING_SSE2
+					}
+
+					for (; position < length; position++)
+					{
+						if (Contains(data[position]) == WantMembers)
+						{
+							return position;
+						}
+					}
+					return NotFound;
+				}
+			};
+		}
+	}
+}
+
+#endif /* _SEARCH_NOSLIB_HPP_ */
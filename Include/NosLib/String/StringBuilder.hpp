@@ -0,0 +1,267 @@
+#ifndef _STRINGBUILDER_NOSLIB_HPP_
+#define _STRINGBUILDER_NOSLIB_HPP_
+
+#include <string>
+#include <string_view>
+#include <format>
+#include <memory>
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+#include <cstring>
+#include <cstddef>
+
+namespace NosLib
+{
+	namespace String
+	{
+		/// <summary>
+		/// builds a string out of many pieces without reallocating as it goes. pieces get appended into chunks, a full chunk is never
+		/// moved or copied, a new (bigger) one is started instead. ToString then copies everything once into a string of the exact size.
+		/// works with std::format_to through std::back_inserter(builder), though Format is faster
+		/// </summary>
+		/// <typeparam name="CharT">- string type</typeparam>
+		template<typename CharT>
+		class StringBuilder
+		{
+		private:
+			struct Chunk
+			{
+				std::unique_ptr<CharT[]> Data;
+				size_t Size = 0;
+				size_t Capacity = 0;
+			};
+
+			std::vector<Chunk> Chunks;
+			size_t TotalSize = 0;
+			size_t ChunkSize;		/* smallest chunk made */
+
+			/// <summary>
+			/// Makes sure the current chunk has room for count more characters
+			/// </summary>
+			/// <returns>where to write them</returns>
+			inline CharT* Room(const size_t& count)
+			{
+				if (!Chunks.empty() && Chunks.back().Capacity - Chunks.back().Size >= count)
+				{
+					return Chunks.back().Data.get() + Chunks.back().Size;
+				}
+
+				/* each new chunk is at least as big as everything so far, so there's only a logarithmic amount of them */
+				size_t capacity = (TotalSize > ChunkSize ? TotalSize : ChunkSize);
+				capacity = (capacity > count ? capacity : count);
+
+				Chunk& chunk = Chunks.emplace_back();
+				chunk.Data = std::make_unique_for_overwrite<CharT[]>(capacity);
+				chunk.Capacity = capacity;
+				return chunk.Data.get();
+			}
+
+			/// <summary>
+			/// Marks count characters written at Room as used
+			/// </summary>
+			inline void Commit(const size_t& count)
+			{
+				Chunks.back().Size += count;
+				TotalSize += count;
+			}
+
+			static inline constexpr size_t LengthOf(const CharT&)
+			{
+				return 1;
+			}
+
+			static inline constexpr size_t LengthOf(const std::basic_string_view<CharT>& part)
+			{
+				return part.size();
+			}
+
+			static inline void CopyInto(CharT*& out, const CharT& character)
+			{
+				*out++ = character;
+			}
+
+			static inline void CopyInto(CharT*& out, const std::basic_string_view<CharT>& part)
+			{
+				if (!part.empty())
+				{
+					std::memcpy(out, part.data(), part.size() * sizeof(CharT));
+				}
+				out += part.size();
+			}
+
+			/// <summary>
+			/// output iterator for Format, writes what fits in the room left and counts everything
+			/// </summary>
+			struct ChunkWriter
+			{
+				using difference_type = std::ptrdiff_t;
+
+				CharT* Out;
+				size_t Room;
+				size_t Count = 0;
+
+				inline ChunkWriter& operator=(const CharT& character)
+				{
+					if (Count < Room)
+					{
+						Out[Count] = character;
+					}
+					Count++;
+					return *this;
+				}
+
+				inline ChunkWriter& operator*() { return *this; }
+				inline ChunkWriter& operator++() { return *this; }
+				inline ChunkWriter& operator++(int) { return *this; }
+			};
+
+		public:
+			using value_type = CharT; /* lets std::back_inserter use push_back */
+
+			/// <summary>
+			/// Makes an empty builder
+			/// </summary>
+			/// <param name="expectedSize">(default = 0) - roughly how big the result will be, the first chunk gets made this big right away</param>
+			/// <param name="chunkSize">(default = 4096) - smallest chunk to make</param>
+			inline StringBuilder(const size_t& expectedSize = 0, const size_t& chunkSize = 4096)
+				: ChunkSize(chunkSize == 0 ? 1 : chunkSize)
+			{
+				if (expectedSize != 0)
+				{
+					Reserve(expectedSize);
+				}
+			}
+
+			/// <summary>
+			/// Makes sure the next count characters can be appended without making a new chunk
+			/// </summary>
+			inline void Reserve(const size_t& count)
+			{
+				Room(count);
+			}
+
+			inline StringBuilder& Append(const std::basic_string_view<CharT>& part)
+			{
+				CharT* out = Room(part.size());
+				CopyInto(out, part);
+				Commit(part.size());
+				return *this;
+			}
+
+			inline StringBuilder& Append(const CharT& character)
+			{
+				*Room(1) = character;
+				Commit(1);
+				return *this;
+			}
+
+			/// <summary>
+			/// Appends character count times
+			/// </summary>
+			inline StringBuilder& Append(const size_t& count, const CharT& character)
+			{
+				std::fill_n(Room(count), count, character);
+				Commit(count);
+				return *this;
+			}
+
+			/// <summary>
+			/// Appends every part (strings, views, literals or single characters) with one size check for all of them
+			/// </summary>
+			template<typename... Parts>
+			inline StringBuilder& AppendAll(const Parts&... parts)
+			{
+				size_t length = (LengthOf(parts) + ... + 0);
+				[[maybe_unused]] CharT* out = Room(length); /* unused when there are no parts */
+				(CopyInto(out, parts), ...);
+				Commit(length);
+				return *this;
+			}
+
+			/// <summary>
+			/// Appends a formatted string, formatting straight into the chunk (only formats twice if it doesn't fit in what's left of it)
+			/// </summary>
+			template<typename... Args>
+			inline StringBuilder& Format(const std::basic_format_string<CharT, std::type_identity_t<Args>...> format, Args&&... args)
+			{
+				/* through vformat_to, the arguments are type erased here so rvalues and lvalues work alike */
+				using ContextT = std::conditional_t<std::is_same_v<CharT, char>, std::format_context, std::wformat_context>;
+				auto arguments = std::make_format_args<ContextT>(args...);
+
+				size_t room = (Chunks.empty() ? 0 : Chunks.back().Capacity - Chunks.back().Size);
+				CharT* out = (Chunks.empty() ? nullptr : Chunks.back().Data.get() + Chunks.back().Size);
+
+				size_t length = std::vformat_to(ChunkWriter{out, room}, format.get(), arguments).Count;
+				if (length == 0) /* nothing to commit, and there might not be a chunk to commit it to */
+				{
+					return *this;
+				}
+				if (length > room) /* didn't fit, what got written is thrown away */
+				{
+					std::vformat_to(Room(length), format.get(), arguments);
+				}
+				Commit(length);
+				return *this;
+			}
+
+			inline StringBuilder& operator+=(const std::basic_string_view<CharT>& part)
+			{
+				return Append(part);
+			}
+
+			inline StringBuilder& operator+=(const CharT& character)
+			{
+				return Append(character);
+			}
+
+			inline void push_back(const CharT& character)
+			{
+				Append(character);
+			}
+
+			/// <summary>
+			/// amount of characters appended so far
+			/// </summary>
+			inline size_t GetSize() const
+			{
+				return TotalSize;
+			}
+
+			/// <summary>
+			/// Copies everything into one string, allocated once at the exact size
+			/// </summary>
+			inline std::basic_string<CharT> ToString() const
+			{
+				std::basic_string<CharT> out(TotalSize, CharT(0));
+				CharT* position = out.data();
+				for (const Chunk& chunk : Chunks)
+				{
+					std::memcpy(position, chunk.Data.get(), chunk.Size * sizeof(CharT));
+					position += chunk.Size;
+				}
+				return out;
+			}
+
+			/// <summary>
+			/// Empties the builder, keeping the last chunk to reuse
+			/// </summary>
+			inline void Clear()
+			{
+				if (Chunks.size() > 1)
+				{
+					Chunk biggest = std::move(Chunks.back());
+					Chunks.clear();
+					Chunks.push_back(std::move(biggest));
+				}
+				if (!Chunks.empty())
+				{
+					Chunks.back().Size = 0;
+				}
+				TotalSize = 0;
+			}
+		};
+	}
+}
+
+#endif /* _STRINGBUILDER_NOSLIB_HPP_ */
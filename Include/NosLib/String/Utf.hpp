@@ -0,0 +1,337 @@
+#ifndef _UTF_NOSLIB_HPP_
+#define _UTF_NOSLIB_HPP_
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+#if defined(_M_X64) || defined(_M_AMD64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define NOSLIB_STRING_SSE2
+#endif
+
+namespace NosLib
+{
+	namespace String
+	{
+		/// <summary>
+		/// UTF-8/UTF-16/UTF-32 transcoding. char and char8_t are UTF-8, char16_t is UTF-16, char32_t is UTF-32 and wchar_t is
+		/// whichever of UTF-16 (Windows) or UTF-32 (everywhere else) fits it. invalid input becomes U+FFFD,
+		/// also between types of the same width
+		/// </summary>
+		namespace Utf
+		{
+			constexpr char32_t ReplacementCharacter = 0xFFFD;
+
+			/// <summary>
+			/// bits per code unit of the encoding CharType uses (8, 16 or 32)
+			/// </summary>
+			template<typename CharType>
+			constexpr int EncodingBits = (int)sizeof(CharType) * 8;
+
+			template<typename CharType>
+			constexpr bool IsUnicodeCharacter = std::is_same_v<CharType, char> || std::is_same_v<CharType, char8_t> || std::is_same_v<CharType, char16_t> ||
+												std::is_same_v<CharType, char32_t> || std::is_same_v<CharType, wchar_t>;
+
+			/// <summary>
+			/// code unit as an unsigned number (char and wchar_t can be signed)
+			/// </summary>
+			template<typename CharType>
+			inline constexpr uint32_t Unit(const CharType& character)
+			{
+				return (uint32_t)(std::make_unsigned_t<CharType>)character;
+			}
+
+			/// <summary>
+			/// Reads one code point, moving position past it
+			/// </summary>
+			/// <param name="in">- input</param>
+			/// <param name="length">- input length</param>
+			/// <param name="position">- where to read from, moved past what was read</param>
+			/// <returns>the code point, ReplacementCharacter if the input there is invalid</returns>
+			template<typename CharFrom>
+			inline constexpr char32_t DecodeOne(const CharFrom* in, const size_t& length, size_t& position)
+			{
+				uint32_t first = Unit(in[position++]);
+
+				if constexpr (EncodingBits<CharFrom> == 8)
+				{
+					if (first < 0x80)
+					{
+						return first;
+					}
+
+					/* the lead decides how many trail bytes follow and which range the first of them can be in, that way overlongs, surrogates
+					   and anything past U+10FFFF get caught at the first bad byte and each bad sequence becomes one U+FFFD (like Unicode recommends) */
+					int trailCount;
+					uint32_t codePoint;
+					uint32_t secondLow = 0x80, secondHigh = 0xBF;
+					if (first >= 0xC2 && first <= 0xDF)
+					{
+						trailCount = 1; codePoint = first & 0x1F;
+					}
+					else if (first >= 0xE0 && first <= 0xEF)
+					{
+						trailCount = 2; codePoint = first & 0x0F;
+						secondLow = (first == 0xE0 ? 0xA0 : 0x80);
+						secondHigh = (first == 0xED ? 0x9F : 0xBF);
+					}
+					else if (first >= 0xF0 && first <= 0xF4)
+					{
+						trailCount = 3; codePoint = first & 0x07;
+						secondLow = (first == 0xF0 ? 0x90 : 0x80);
+						secondHigh = (first == 0xF4 ? 0x8F : 0xBF);
+					}
+					else /* stray trail byte or invalid lead */
+					{
+						return ReplacementCharacter;
+					}
+
+					for (int i = 0; i < trailCount; i++)
+					{
+						uint32_t low = (i == 0 ? secondLow : 0x80);
+						uint32_t high = (i == 0 ? secondHigh : 0xBF);
+						if (position >= length || Unit(in[position]) < low || Unit(in[position]) > high) /* truncated, the bad byte gets looked at again on its own */
+						{
+							return ReplacementCharacter;
+						}
+						codePoint = (codePoint << 6) | (Unit(in[position++]) & 0x3F);
+					}
+
+					return codePoint;
+				}
+				else if constexpr (EncodingBits<CharFrom> == 16)
+				{
+					if (first < 0xD800 || first > 0xDFFF)
+					{
+						return first;
+					}
+					if (first <= 0xDBFF && position < length && Unit(in[position]) >= 0xDC00 && Unit(in[position]) <= 0xDFFF)
+					{
+						uint32_t second = Unit(in[position++]);
+						return 0x10000 + ((first - 0xD800) << 10) + (second - 0xDC00);
+					}
+					return ReplacementCharacter; /* lone surrogate */
+				}
+				else
+				{
+					return ((first > 0x10FFFF || (first >= 0xD800 && first <= 0xDFFF)) ? ReplacementCharacter : first);
+				}
+			}
+
+			/// <summary>
+			/// Writes one code point (has to be valid), out needs room for 4 units
+			/// </summary>
+			/// <returns>amount of units written</returns>
+			template<typename CharTo>
+			inline constexpr size_t EncodeOne(const char32_t& codePoint, CharTo* out)
+			{
+				if constexpr (EncodingBits<CharTo> == 8)
+				{
+					if (codePoint < 0x80)
+					{
+						out[0] = (CharTo)codePoint;
+						return 1;
+					}
+					if (codePoint < 0x800)
+					{
+						out[0] = (CharTo)(0xC0 | (codePoint >> 6));
+						out[1] = (CharTo)(0x80 | (codePoint & 0x3F));
+						return 2;
+					}
+					if (codePoint < 0x10000)
+					{
+						out[0] = (CharTo)(0xE0 | (codePoint >> 12));
+						out[1] = (CharTo)(0x80 | ((codePoint >> 6) & 0x3F));
+						out[2] = (CharTo)(0x80 | (codePoint & 0x3F));
+						return 3;
+					}
+					out[0] = (CharTo)(0xF0 | (codePoint >> 18));
+					out[1] = (CharTo)(0x80 | ((codePoint >> 12) & 0x3F));
+					out[2] = (CharTo)(0x80 | ((codePoint >> 6) & 0x3F));
+					out[3] = (CharTo)(0x80 | (codePoint & 0x3F));
+					return 4;
+				}
+				else if constexpr (EncodingBits<CharTo> == 16)
+				{
+					if (codePoint < 0x10000)
+					{
+						out[0] = (CharTo)codePoint;
+						return 1;
+					}
+					out[0] = (CharTo)(0xD800 + ((codePoint - 0x10000) >> 10));
+					out[1] = (CharTo)(0xDC00 + ((codePoint - 0x10000) & 0x3FF));
+					return 2;
+				}
+				else
+				{
+					out[0] = (CharTo)codePoint;
+					return 1;
+				}
+			}
+
+			/// <summary>
+			/// Copies the ASCII run at the start of in to out, 16 units per step where SSE2 is there
+			/// </summary>
+			/// <returns>amount of units copied (stops at the first non ASCII unit)</returns>
+			template<typename CharTo, typename CharFrom>
+			inline size_t CopyAscii(const CharFrom* in, const size_t& length, CharTo* out)
+			{
+				size_t position = 0;
+
+			#ifdef NOSLIB_STRING_SSE2
+				const __m128i zero = _mm_setzero_si128();
+				for (; position + 16 <= length; position += 16)
+				{
+					if constexpr (EncodingBits<CharFrom> == 8)
+					{
+						__m128i bytes = _mm_loadu_si128((const __m128i*)(in + position));
+						if (_mm_movemask_epi8(bytes) != 0) /* a byte has its top bit set */
+						{
+							break;
+						}
+
+						if constexpr (EncodingBits<CharTo> == 8)
+						{
+							_mm_storeu_si128((__m128i*)(out + position), bytes);
+							continue;
+						}
+
+						__m128i low = _mm_unpacklo_epi8(bytes, zero);
+						__m128i high = _mm_unpackhi_epi8(bytes, zero);
+						if constexpr (EncodingBits<CharTo> == 16)
+						{
+							_mm_storeu_si128((__m128i*)(out + position), low);
+							_mm_storeu_si128((__m128i*)(out + position + 8), high);
+						}
+						else
+						{
+							_mm_storeu_si128((__m128i*)(out + position), _mm_unpacklo_epi16(low, zero));
+							_mm_storeu_si128((__m128i*)(out + position + 4), _mm_unpackhi_epi16(low, zero));
+							_mm_storeu_si128((__m128i*)(out + position + 8), _mm_unpacklo_epi16(high, zero));
+							_mm_storeu_si128((__m128i*)(out + position + 12), _mm_unpackhi_epi16(high, zero));
+						}
+					}
+					else if constexpr (EncodingBits<CharFrom> == 16)
+					{
+						__m128i first = _mm_loadu_si128((const __m128i*)(in + position));
+						__m128i second = _mm_loadu_si128((const __m128i*)(in + position + 8));
+						__m128i nonAscii = _mm_and_si128(_mm_or_si128(first, second), _mm_set1_epi16((short)0xFF80));
+						if (_mm_movemask_epi8(_mm_cmpeq_epi16(nonAscii, zero)) != 0xFFFF)
+						{
+							break;
+						}
+
+						if constexpr (EncodingBits<CharTo> == 8)
+						{
+							_mm_storeu_si128((__m128i*)(out + position), _mm_packus_epi16(first, second));
+						}
+						else if constexpr (EncodingBits<CharTo> == 16)
+						{
+							_mm_storeu_si128((__m128i*)(out + position), first);
+							_mm_storeu_si128((__m128i*)(out + position + 8), second);
+						}
+						else
+						{
+							_mm_storeu_si128((__m128i*)(out + position), _mm_unpacklo_epi16(first, zero));
+							_mm_storeu_si128((__m128i*)(out + position + 4), _mm_unpackhi_epi16(first, zero));
+							_mm_storeu_si128((__m128i*)(out + position + 8), _mm_unpacklo_epi16(second, zero));
+							_mm_storeu_si128((__m128i*)(out + position + 12), _mm_unpackhi_epi16(second, zero));
+						}
+					}
+					else
+					{
+						__m128i part0 = _mm_loadu_si128((const __m128i*)(in + position));
+						__m128i part1 = _mm_loadu_si128((const __m128i*)(in + position + 4));
+						__m128i part2 = _mm_loadu_si128((const __m128i*)(in + position + 8));
+						__m128i part3 = _mm_loadu_si128((const __m128i*)(in + position + 12));
+						__m128i nonAscii = _mm_and_si128(_mm_or_si128(_mm_or_si128(part0, part1), _mm_or_si128(part2, part3)), _mm_set1_epi32((int)0xFFFFFF80));
+						if (_mm_movemask_epi8(_mm_cmpeq_epi32(nonAscii, zero)) != 0xFFFF)
+						{
+							break;
+						}
+
+						if constexpr (EncodingBits<CharTo> == 32)
+						{
+							_mm_storeu_si128((__m128i*)(out + position), part0);
+							_mm_storeu_si128((__m128i*)(out + position + 4), part1);
+							_mm_storeu_si128((__m128i*)(out + position + 8), part2);
+							_mm_storeu_si128((__m128i*)(out + position + 12), part3);
+							continue;
+						}
+
+						__m128i low = _mm_packs_epi32(part0, part1); /* every value is below 0x80, so the saturating packs are exact */
+						__m128i high = _mm_packs_epi32(part2, part3);
+						if constexpr (EncodingBits<CharTo> == 8)
+						{
+							_mm_storeu_si128((__m128i*)(out + position), _mm_packus_epi16(low, high));
+						}
+						else
+						{
+							_mm_storeu_si128((__m128i*)(out + position), low);
+							_mm_storeu_si128((__m128i*)(out + position + 8), high);
+						}
+					}
+				}
+			#endif // NOSLIB_STRING_SSE2
+
+				for (; position < length && Unit(in[position]) < 0x80; position++)
+				{
+					out[position] = (CharTo)in[position];
+				}
+				return position;
+			}
+
+			/// <summary>
+			/// Converts between encodings. the output is sized for the input being ASCII and only grows when it isn't
+			/// </summary>
+			/// <param name="in">- input</param>
+			/// <param name="length">- input length in units</param>
+			/// <returns>converted string</returns>
+			template<typename CharTo, typename CharFrom>
+			inline constexpr std::basic_string<CharTo> Transcode(const CharFrom* in, const size_t& length)
+			{
+				static_assert(IsUnicodeCharacter<CharTo> && IsUnicodeCharacter<CharFrom>, "Transcode only works between char, char8_t, char16_t, char32_t and wchar_t");
+
+				std::basic_string<CharTo> out(length, CharTo(0));
+
+				size_t position = 0;
+				size_t written = 0;
+
+				while (position < length)
+				{
+					if (Unit(in[position]) < 0x80)
+					{
+						if (!std::is_constant_evaluated())
+						{
+							size_t copied = CopyAscii(in + position, length - position, out.data() + written);
+							position += copied;
+							written += copied;
+							continue;
+						}
+
+						out[written++] = (CharTo)in[position++];
+						continue;
+					}
+
+					/* a narrower (or UTF-8 to UTF-8, a bad byte becomes 3) encoding can need more units than it read, keep room for the longest encoding plus the rest being ASCII */
+					if (EncodingBits<CharTo> <= EncodingBits<CharFrom> && out.size() - written < (length - position) + 3)
+					{
+						size_t grownSize = out.size() * 2;
+						size_t neededSize = written + (length - position) + 3;
+						out.resize(grownSize > neededSize ? grownSize : neededSize);
+					}
+
+					written += EncodeOne(DecodeOne(in, length, position), out.data() + written);
+				}
+
+				out.resize(written);
+				return out;
+			}
+		}
+	}
+}
+
+#endif /* _UTF_NOSLIB_HPP_ */
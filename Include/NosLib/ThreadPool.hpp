@@ -4,63 +4,728 @@
 #include "DynamicArray.hpp"
 #include "Logging.hpp"
 #include "Functional.hpp"
+#include "ConcurrentQueue.hpp"
+#include "ThreadPool/WorkStealingDeque.hpp"
+#include "ThreadPool/Topology.hpp"
+#include "ThreadPool/Statistics.hpp"
 
 #include <mutex>
 #include <condition_variable>
 #include <thread>
+#include <atomic>
+#include <functional>
+#include <deque>
+#include <vector>
+#include <string>
+#include <exception>
+#include <stdexcept>
+#include <algorithm>
+#include <type_traits>
+#include <chrono>
 #include <cstdint>
 
 namespace NosLib
 {
 	class ThreadPool
 	{
+	public:
+		/// <summary>
+		/// how ParallelFor splits its range between the workers
+		/// </summary>
+		enum class Partitioning : uint8_t
+		{
+			Static,		/* one equal contiguous block per participant, lowest overhead for uniform iterations */
+			Dynamic,	/* participants keep grabbing grainSize chunks, best for uneven iterations */
+			Guided,		/* chunks start big (remaining / participants) and shrink down to grainSize */
+		};
+
+		/// <summary>
+		/// task priority, higher priority tasks get picked first. lower priority tasks which waited longer then the starvation limit get picked before everything else
+		/// </summary>
+		enum class Priority : uint8_t
+		{
+			High,		/* latency critical work */
+			Normal,		/* default */
+			Background,	/* batch work that should only use otherwise idle workers */
+		};
+
+		/// <summary>
+		/// how threads get pinned to cpus
+		/// </summary>
+		enum class Affinity : uint8_t
+		{
+			None,		/* let the OS move threads around */
+			Compact,	/* pack threads onto one NUMA node before moving onto the next, keeps shared data in one cache/memory domain */
+			Spread,		/* round robin threads across NUMA nodes, gives each thread the most memory bandwidth */
+		};
+
+		/// <summary>
+		/// Latch style completion tracker for a set of tasks. counts up with Run and down as the tasks finish.
+		/// waiting from inside a worker runs other queued tasks instead of blocking it
+		/// </summary>
+		class TaskGroup
+		{
+		protected:
+			ThreadPool* Pool;								/* pool the tasks get submitted to */
+			std::atomic<int64_t> Outstanding = 0;			/* tasks which haven't finished */
+			std::mutex CompletionMutex;						/* protects FirstException and the CV predicate */
+			std::condition_variable CompletionCV;
+			std::exception_ptr FirstException = nullptr;	/* first exception thrown by a task, rethrown by Wait */
+
+			inline void FinishOne(const std::exception_ptr& exception)
+			{
+				std::lock_guard<std::mutex> lock(CompletionMutex);
+				if (exception && !FirstException)
+				{
+					FirstException = exception;
+				}
+
+				if (Outstanding.fetch_sub(1) == 1)
+				{
+					CompletionCV.notify_all();
+				}
+			}
+
+			/// <summary>
+			/// waits until Outstanding is 0 or the deadline passes
+			/// </summary>
+			/// <param name="deadline">- when to give up (nullptr to never give up)</param>
+			/// <returns>if all tasks finished</returns>
+			inline bool WaitUntil(const std::chrono::steady_clock::time_point* deadline)
+			{
+				bool helping = (CurrentPool == Pool); /* blocking a worker could deadlock the pool */
+				auto finished = [this]() { return Outstanding.load() == 0; };
+
+				while (!finished())
+				{
+					if (deadline != nullptr && std::chrono::steady_clock::now() >= *deadline)
+					{
+						return false;
+					}
+
+					if (helping && Pool->TryRunPendingTask())
+					{
+						continue;
+					}
+
+					std::unique_lock<std::mutex> lock(CompletionMutex);
+					if (helping) /* only nap, new work to help with could show up */
+					{
+						CompletionCV.wait_for(lock, std::chrono::microseconds(100), finished);
+					}
+					else if (deadline != nullptr)
+					{
+						CompletionCV.wait_until(lock, *deadline, finished);
+					}
+					else
+					{
+						CompletionCV.wait(lock, finished);
+					}
+				}
+
+				std::lock_guard<std::mutex> lock(CompletionMutex); /* last FinishOne might still be holding it, don't let the group get destroyed under it */
+				return true;
+			}
+
+			inline void RethrowException()
+			{
+				std::exception_ptr exception;
+				{
+					std::lock_guard<std::mutex> lock(CompletionMutex);
+					exception = FirstException;
+					FirstException = nullptr;
+				}
+
+				if (exception)
+				{
+					std::rethrow_exception(exception);
+				}
+			}
+
+		public:
+			/// <summary>
+			/// Constructor
+			/// </summary>
+			/// <param name="pool">- pool the tasks will run on</param>
+			inline TaskGroup(ThreadPool* pool)
+			{
+				Pool = pool;
+			}
+
+			TaskGroup(const TaskGroup&) = delete;
+			TaskGroup& operator=(const TaskGroup&) = delete;
+
+			/* waits for any tasks left, exceptions get dropped */
+			inline ~TaskGroup()
+			{
+				WaitUntil(nullptr);
+			}
+
+			/// <summary>
+			/// Submits task to the pool as part of this group
+			/// </summary>
+			/// <typeparam name="Callable">- any callable taking no arguments</typeparam>
+			/// <param name="task">- the task</param>
+			/// <param name="priority">(default = Priority::Normal) - task priority</param>
+			template<class Callable>
+			inline void Run(Callable&& task, const Priority& priority = Priority::Normal)
+			{
+				Outstanding.fetch_add(1);
+				Pool->Submit([this, task = std::forward<Callable>(task)]() mutable
+				{
+					std::exception_ptr exception = nullptr;
+					try
+					{
+						task();
+					}
+					catch (...)
+					{
+						exception = std::current_exception();
+					}
+					FinishOne(exception);
+				}, priority);
+			}
+
+			/// <summary>
+			/// Waits for every task in the group, rethrows the first exception a task threw
+			/// </summary>
+			inline void Wait()
+			{
+				WaitUntil(nullptr);
+				RethrowException();
+			}
+
+			/// <summary>
+			/// Waits for every task in the group or for the timeout to run out
+			/// </summary>
+			/// <param name="timeout">- longest time to wait</param>
+			/// <returns>true if every task finished, false if it timed out</returns>
+			template<class Rep, class Period>
+			inline bool WaitFor(const std::chrono::duration<Rep, Period>& timeout)
+			{
+				std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + timeout;
+				if (!WaitUntil(&deadline))
+				{
+					return false;
+				}
+
+				RethrowException();
+				return true;
+			}
+
+			/// <summary>
+			/// if every task in the group has finished
+			/// </summary>
+			/// <returns>if the group is done</returns>
+			inline bool IsDone() const
+			{
+				return Outstanding.load() == 0;
+			}
+		};
+
 	protected:
+		/// <summary>
+		/// a single unit of work submitted to the pool
+		/// </summary>
+		struct PoolTask
+		{
+			std::function<void()> Function;											/* the work itself */
+			Priority TaskPriority = Priority::Normal;								/* which queue it goes into */
+			std::chrono::steady_clock::time_point Deadline = NoDeadline;			/* task gets dropped if it hasn't started by then */
+			std::function<void()> OnExpired;										/* called instead of Function if the deadline passed (can be empty) */
+			std::chrono::steady_clock::time_point EnqueueTime;						/* when it got queued, used for aging and queue wait statistics */
+		};
+
+		static constexpr std::chrono::steady_clock::time_point NoDeadline = std::chrono::steady_clock::time_point::max();
+		static constexpr int PriorityCount = 3;
+		static constexpr unsigned int MinSpinCount = 16;		/* spin limit never adapts below this */
+		static constexpr unsigned int StartSpinCount = 256;		/* spin limit a new worker starts with */
+
+		/// <summary>
+		/// a persistent worker thread with its own work stealing deque
+		/// </summary>
+		struct Worker
+		{
+			NosLib::WorkStealingDeque<PoolTask*> LocalQueue;	/* tasks submitted from this worker, other workers steal from it */
+			std::thread Thread;									/* the actual thread */
+			unsigned int Index = 0;								/* position in Workers array */
+			uint64_t RandomState = 0;							/* xorshift state used to pick steal victims */
+			NosLib::WorkerStatistics Statistics;				/* counters and latency histograms, only written by this worker */
+			std::atomic<bool> Active = false;					/* if a thread is running in this slot, slots get reused once a worker retires */
+			unsigned int SpinLimit = StartSpinCount;			/* how long to spin before parking, adapts to how often spinning finds work */
+
+			/// <summary>
+			/// xorshift64, good enough for picking steal victims
+			/// </summary>
+			/// <returns>next pseudo random number</returns>
+			inline uint64_t NextRandom()
+			{
+				RandomState ^= RandomState << 13;
+				RandomState ^= RandomState >> 7;
+				RandomState ^= RandomState << 17;
+				return RandomState;
+			}
+		};
+
 		NosLib::DynamicArray<std::thread*> ThreadPoolArray;
 		NosLib::FunctionStoreBase* ThreadFunction;
 
 		std::mutex threadJoinMutex;
 		std::condition_variable threadJoinCV;
+		bool PoolRunning = false;						/* if StartThreadPool work is running, guarded by threadJoinMutex */
 
 		constexpr static unsigned int DefaultCoreCount = 8;
 		float ThreadMultiplier = 1;
 		unsigned int CustomThreadCount = 0;
 
+		Affinity ThreadAffinity = Affinity::None;		/* how threads get pinned */
+		std::string ThreadNamePrefix = "NosPool";		/* threads are named "{prefix}-W{index}" (workers) or "{prefix}-J{index}" (StartThreadPool) */
+		bool RespectCpuLimits = true;					/* size the pool by allowed cpus and cgroup quota instead of hardware_concurrency */
+		std::vector<unsigned int> JobCpuPlan;			/* cpu for each StartThreadPool thread index, empty when not pinning. only rebuilt while no job threads run */
+		std::vector<unsigned int> WorkerCpuPlan;		/* cpu for each worker slot, empty when not pinning. only rebuilt while no workers exist */
+
+		Worker* Workers = nullptr;						/* task mode worker slots, array of WorkerCount */
+		unsigned int WorkerCount = 0;					/* amount of worker slots, the most workers that can run at once */
+		unsigned int MinWorkerCount = 0;				/* idle workers never retire below this */
+		std::atomic<unsigned int> ActiveWorkerCount = 0;	/* workers currently running */
+		std::chrono::steady_clock::duration WorkerIdleTimeout = std::chrono::steady_clock::duration::zero(); /* how long a parked worker waits before retiring (zero never retires) */
+		std::atomic<unsigned int> MaxSpinCount = 4096;	/* upper bound for Worker::SpinLimit, 0 parks straight away */
+		std::atomic<int> SpinningWorkers = 0;			/* workers spinning before parking, they will pick up new tasks without a wakeup */
+		std::mutex GrowMutex;							/* protects starting workers and the Thread objects of the slots */
+
+		std::mutex InjectionMutex;									/* protects InjectionQueues */
+		std::deque<PoolTask*> InjectionQueues[PriorityCount];		/* per priority, tasks submitted from outside the pool and every non Normal task */
+		std::atomic<int64_t> InjectedCounts[PriorityCount] = {};	/* size of each injection queue, lets FindTask skip the mutex */
+		std::chrono::steady_clock::duration StarvationLimit = std::chrono::milliseconds(100); /* lower priority tasks waiting longer then this get promoted */
+		std::atomic<uint64_t> ExpiredTaskCount = 0;					/* tasks dropped because their deadline passed */
+		std::atomic<int64_t> InjectionHighWater[PriorityCount] = {};	/* largest each injection queue has been */
+
+		std::atomic<bool> StatisticsEnabled = true;		/* if task timings get recorded (counters are always kept) */
+		NosLib::WorkerStatistics ExternalStatistics;	/* tasks run by threads which aren't workers (TryRunPendingTask from outside) */
+
+		std::atomic<int64_t> QueuedTaskCount = 0;		/* tasks sitting in any queue, used to decide if workers should sleep */
+		std::atomic<int> SleepingWorkers = 0;			/* amount of workers waiting on SleepCV */
+		std::atomic<bool> StopRequested = false;		/* tells workers to exit once the queues are empty */
+		std::mutex SleepMutex;
+		std::condition_variable SleepCV;
+
+		std::atomic<int64_t> PendingTaskCount = 0;		/* tasks submitted but not finished running, used by WaitIdle */
+		std::mutex IdleMutex;
+		std::condition_variable IdleCV;
+
+		static inline thread_local ThreadPool* CurrentPool = nullptr;	/* pool which owns the current thread (if it is a worker) */
+		static inline thread_local Worker* CurrentWorker = nullptr;		/* worker object of the current thread (if it is a worker) */
+		static inline thread_local int RunTaskDepth = 0;				/* tasks nested on the current thread (helping while waiting), only the outermost counts as busy time */
+
 		inline void ManageThreads()
 		{
 			for (int i = 0; i <= ThreadPoolArray.GetLastArrayIndex(); /* ArrayIndex will go down */)
 			{
 				ThreadPoolArray[i]->join();
 				ThreadPoolArray.Remove(i);
-				NosLib::Logging::CreateLog<char>(std::format("Thread {} finished", i), NosLib::Logging::Severity::Debug);
+				NOSLIB_LOG(NosLib::Logging::Severity::Debug, "Thread {} finished", i);
 			}
 
 			delete ThreadFunction;
 
-			NosLib::Logging::CreateLog<char>("Thread Pool finished work", NosLib::Logging::Severity::Debug);
+			NOSLIB_LOG_DEBUG("Thread Pool finished work");
 		}
 
 		inline void ThreadPoolManagement()
 		{
-			std::lock_guard<std::mutex> lk(threadJoinMutex);
-
 			unsigned int threadCount = GetAmountOfCores();
+			JobCpuPlan = BuildCpuPlan(threadCount);
 
 			for (unsigned int i = 0; i < threadCount; i++)
 			{
-				ThreadPoolArray.Append(new std::thread([this]() { ThreadFunction->RunFunction(); }));
-				NosLib::Logging::CreateLog<char>(std::format("Thread {} started", i), NosLib::Logging::Severity::Debug);
+				ThreadPoolArray.Append(new std::thread([this, i]()
+				{
+					PrepareCurrentThread(std::format("{}-J{}", ThreadNamePrefix, i), JobCpuPlan, i);
+					ThreadFunction->RunFunction();
+				}));
+				NOSLIB_LOG(NosLib::Logging::Severity::Debug, "Thread {} started", i);
 				//Sleep(1); /* desync threads */
 			}
 
 			ManageThreads();
+
+			/* notify while holding the lock, so a joiner can't destroy the pool before this thread is done with it */
+			std::lock_guard<std::mutex> lk(threadJoinMutex);
+			PoolRunning = false;
 			threadJoinCV.notify_all();
 			/* in theory, thread deletes itself here */
 		}
 
+		/// <summary>
+		/// statistics a thread should record into
+		/// </summary>
+		/// <param name="worker">- worker (nullptr if not a worker)</param>
+		/// <returns>the worker's statistics or ExternalStatistics</returns>
+		inline NosLib::WorkerStatistics& StatisticsFor(Worker* worker)
+		{
+			return (worker != nullptr ? worker->Statistics : ExternalStatistics);
+		}
+
+		/// <summary>
+		/// Runs a task and deletes it. exceptions are logged instead of taking down the worker
+		/// </summary>
+		/// <param name="task">- task to run</param>
+		/// <param name="statistics">- statistics of the thread running it</param>
+		inline void RunTask(PoolTask* task, NosLib::WorkerStatistics& statistics)
+		{
+			bool timed = StatisticsEnabled.load(std::memory_order_relaxed);
+			int64_t startTime = 0;
+			RunTaskDepth++;
+			if (timed)
+			{
+				startTime = NosLib::WorkerStatistics::Now();
+				if (task->EnqueueTime != std::chrono::steady_clock::time_point())
+				{
+					int64_t enqueueTime = std::chrono::duration_cast<std::chrono::nanoseconds>(task->EnqueueTime.time_since_epoch()).count();
+					statistics.QueueWait.Record((uint64_t)(startTime > enqueueTime ? startTime - enqueueTime : 0));
+				}
+			}
+
+			try
+			{
+				if (task->Deadline != NoDeadline && std::chrono::steady_clock::now() > task->Deadline)
+				{
+					ExpiredTaskCount.fetch_add(1);
+					if (task->OnExpired)
+					{
+						task->OnExpired();
+					}
+				}
+				else
+				{
+					task->Function();
+				}
+			}
+			catch (const std::exception& exception)
+			{
+				NOSLIB_LOG(NosLib::Logging::Severity::Error, "Thread Pool task threw: {}", exception.what());
+			}
+			catch (...)
+			{
+				NOSLIB_LOG_ERROR("Thread Pool task threw an unknown exception");
+			}
+
+			delete task;
+
+			RunTaskDepth--;
+			statistics.TasksExecuted.fetch_add(1, std::memory_order_relaxed);
+			if (timed)
+			{
+				uint64_t executionTime = (uint64_t)(NosLib::WorkerStatistics::Now() - startTime);
+				statistics.Execution.Record(executionTime);
+				if (RunTaskDepth == 0)
+				{
+					statistics.BusyNanoseconds.fetch_add(executionTime, std::memory_order_relaxed);
+				}
+			}
+
+			if (PendingTaskCount.fetch_sub(1) == 1) /* pool just went idle */
+			{
+				std::lock_guard<std::mutex> lock(IdleMutex);
+				IdleCV.notify_all();
+			}
+		}
+
+		/// <summary>
+		/// Takes the most important injected task. a lower priority task which has been waiting past StarvationLimit goes first
+		/// </summary>
+		/// <param name="includeBackground">- if Background tasks can be taken (only once there is nothing else to do)</param>
+		/// <returns>task or nullptr if there are none</returns>
+		inline PoolTask* TakeInjectedTask(const bool& includeBackground)
+		{
+			if (InjectedCounts[(int)Priority::High].load() == 0 && InjectedCounts[(int)Priority::Normal].load() == 0 && InjectedCounts[(int)Priority::Background].load() == 0)
+			{
+				return nullptr;
+			}
+
+			std::lock_guard<std::mutex> lock(InjectionMutex);
+			std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+			auto take = [this](const int& priority)
+			{
+				PoolTask* task = InjectionQueues[priority].front();
+				InjectionQueues[priority].pop_front();
+				InjectedCounts[priority].fetch_sub(1);
+				return task;
+			};
+
+			/* aging, lowest priority first since it is the one most likely to be starved */
+			for (int priority = PriorityCount - 1; priority > (int)Priority::High; priority--)
+			{
+				if (!InjectionQueues[priority].empty() && now - InjectionQueues[priority].front()->EnqueueTime >= StarvationLimit)
+				{
+					return take(priority);
+				}
+			}
+
+			int lowestPriority = (includeBackground ? (int)Priority::Background : (int)Priority::Normal);
+			for (int priority = (int)Priority::High; priority <= lowestPriority; priority++)
+			{
+				if (!InjectionQueues[priority].empty())
+				{
+					return take(priority);
+				}
+			}
+
+			return nullptr;
+		}
+
+		/// <summary>
+		/// Tries to steal a task from other workers, starting at a random victim
+		/// </summary>
+		/// <param name="thief">- worker doing the stealing (nullptr if not a worker)</param>
+		/// <returns>task or nullptr if nothing could be stolen</returns>
+		inline PoolTask* StealTask(Worker* thief)
+		{
+			if (WorkerCount == 0)
+			{
+				return nullptr;
+			}
+
+			unsigned int start = (thief != nullptr ? (unsigned int)(thief->NextRandom() % WorkerCount) : 0);
+			PoolTask* task = nullptr;
+
+			for (unsigned int i = 0; i < WorkerCount; i++)
+			{
+				Worker* victim = &Workers[(start + i) % WorkerCount];
+				if (victim == thief || !victim->Active.load(std::memory_order_relaxed))
+				{
+					continue;
+				}
+
+				if (victim->LocalQueue.Steal(&task))
+				{
+					StatisticsFor(thief).StealCount.fetch_add(1, std::memory_order_relaxed);
+					return task;
+				}
+			}
+
+			return nullptr;
+		}
+
+		/// <summary>
+		/// Finds the next task for a thread. order is: High priority, local deque (newest, cache warm), injected Normal tasks, stealing, Background tasks
+		/// </summary>
+		/// <param name="worker">- worker looking for work (nullptr if not a worker)</param>
+		/// <returns>task or nullptr if there was no work</returns>
+		inline PoolTask* FindTask(Worker* worker)
+		{
+			PoolTask* task = nullptr;
+
+			if ((InjectedCounts[(int)Priority::High].load(std::memory_order_relaxed) > 0 && (task = TakeInjectedTask(false)) != nullptr) ||
+				(worker != nullptr && worker->LocalQueue.Pop(&task)) ||
+				(task = TakeInjectedTask(false)) != nullptr ||
+				(task = StealTask(worker)) != nullptr ||
+				(task = TakeInjectedTask(true)) != nullptr)
+			{
+				QueuedTaskCount.fetch_sub(1);
+				return task;
+			}
+
+			return nullptr;
+		}
+
+		/// <summary>
+		/// Main loop of a task mode worker
+		/// </summary>
+		/// <param name="worker">- the worker this thread is</param>
+		inline void WorkerLoop(Worker* worker)
+		{
+			CurrentPool = this;
+			CurrentWorker = worker;
+			PrepareCurrentThread(std::format("{}-W{}", ThreadNamePrefix, worker->Index), WorkerCpuPlan, worker->Index);
+
+			while (true)
+			{
+				PoolTask* task = FindTask(worker);
+				if (task != nullptr)
+				{
+					RunTask(task, worker->Statistics);
+					continue;
+				}
+
+				if (SpinForWork(worker))
+				{
+					continue;
+				}
+
+				std::unique_lock<std::mutex> lock(SleepMutex);
+				auto wake = [this]() { return StopRequested.load() || QueuedTaskCount.load() > 0; };
+				bool woken = true;
+
+				SleepingWorkers.fetch_add(1);
+				if (WorkerIdleTimeout > std::chrono::steady_clock::duration::zero() && ActiveWorkerCount.load() > MinWorkerCount)
+				{
+					woken = SleepCV.wait_for(lock, WorkerIdleTimeout, wake);
+				}
+				else
+				{
+					SleepCV.wait(lock, wake);
+				}
+				SleepingWorkers.fetch_sub(1);
+
+				if (!woken) /* idle for the whole timeout, retire if the pool is above its minimum. done under SleepMutex so EnqueueTask sees an exact SleepingWorkers */
+				{
+					unsigned int activeWorkers = ActiveWorkerCount.load();
+					if (activeWorkers > MinWorkerCount && ActiveWorkerCount.compare_exchange_strong(activeWorkers, activeWorkers - 1))
+					{
+						worker->Active.store(false);
+						break;
+					}
+					continue;
+				}
+
+				if (StopRequested.load() && QueuedTaskCount.load() <= 0)
+				{
+					break;
+				}
+			}
+
+			CurrentPool = nullptr;
+			CurrentWorker = nullptr;
+		}
+
+		/// <summary>
+		/// Puts task into the best queue and wakes a sleeping worker
+		/// </summary>
+		/// <param name="task">- task to enqueue</param>
+		inline void EnqueueTask(PoolTask* task)
+		{
+			PendingTaskCount.fetch_add(1);
+
+			if (task->TaskPriority == Priority::Normal && CurrentPool == this && CurrentWorker != nullptr) /* submitted from one of our workers, keep it local */
+			{
+				if (StatisticsEnabled.load(std::memory_order_relaxed))
+				{
+					task->EnqueueTime = std::chrono::steady_clock::now();
+				}
+				CurrentWorker->LocalQueue.Push(task);
+				CurrentWorker->Statistics.UpdateHighWater(CurrentWorker->LocalQueue.Size());
+			}
+			else
+			{
+				task->EnqueueTime = std::chrono::steady_clock::now();
+				std::lock_guard<std::mutex> lock(InjectionMutex);
+				std::deque<PoolTask*>& queue = InjectionQueues[(int)task->TaskPriority];
+				queue.push_back(task);
+				InjectedCounts[(int)task->TaskPriority].fetch_add(1);
+
+				if ((int64_t)queue.size() > InjectionHighWater[(int)task->TaskPriority].load(std::memory_order_relaxed))
+				{
+					InjectionHighWater[(int)task->TaskPriority].store((int64_t)queue.size(), std::memory_order_relaxed);
+				}
+			}
+
+			QueuedTaskCount.fetch_add(1);
+
+			bool needWorker = false;
+			if (SleepingWorkers.load() > 0)
+			{
+				{
+					std::lock_guard<std::mutex> lock(SleepMutex); /* makes sure a worker between checking and waiting doesn't miss the notify */
+					needWorker = (SleepingWorkers.load() == 0); /* the sleeper retired in the meantime */
+				}
+				SleepCV.notify_one();
+			}
+			else
+			{
+				needWorker = (SpinningWorkers.load() == 0);
+			}
+
+			if (needWorker && ActiveWorkerCount.load() < WorkerCount) /* everyone is busy, grow the pool */
+			{
+				GrowWorkers();
+			}
+		}
+
+		/// <summary>
+		/// Spins for a short while waiting for new tasks, avoids the cost of parking and waking for bursty work.
+		/// the spin limit doubles when spinning finds work and halves when it doesn't
+		/// </summary>
+		/// <param name="worker">- the spinning worker</param>
+		/// <returns>if there is work to look for</returns>
+		inline bool SpinForWork(Worker* worker)
+		{
+			unsigned int spinLimit = std::min(worker->SpinLimit, MaxSpinCount.load(std::memory_order_relaxed));
+			if (spinLimit == 0)
+			{
+				return false;
+			}
+
+			bool found = false;
+			SpinningWorkers.fetch_add(1);
+			for (unsigned int i = 0; i < spinLimit && !StopRequested.load(std::memory_order_relaxed); i++)
+			{
+				if (QueuedTaskCount.load(std::memory_order_relaxed) > 0)
+				{
+					found = true;
+					break;
+				}
+				NosLib::Backoff::CpuRelax();
+			}
+			SpinningWorkers.fetch_sub(1);
+
+			worker->SpinLimit = (found ? std::min(spinLimit * 2, MaxSpinCount.load(std::memory_order_relaxed)) : std::max(spinLimit / 2, MinSpinCount));
+			return found;
+		}
+
+		/// <summary>
+		/// Starts a worker thread in slot index. GrowMutex has to be held
+		/// </summary>
+		/// <param name="index">- slot index</param>
+		inline void StartWorker(const unsigned int& index)
+		{
+			Worker& worker = Workers[index];
+			if (worker.Thread.joinable()) /* thread of a retired worker, it already left WorkerLoop */
+			{
+				worker.Thread.join();
+			}
+
+			worker.Active.store(true);
+			ActiveWorkerCount.fetch_add(1);
+			worker.Thread = std::thread(&ThreadPool::WorkerLoop, this, &worker);
+			NOSLIB_LOG(NosLib::Logging::Severity::Debug, "Worker {} started", index);
+		}
+
+		/// <summary>
+		/// Starts one more worker if the pool is below its maximum
+		/// </summary>
+		inline void GrowWorkers()
+		{
+			std::lock_guard<std::mutex> lock(GrowMutex);
+			if (StopRequested.load() || ActiveWorkerCount.load() >= WorkerCount)
+			{
+				return;
+			}
+
+			for (unsigned int i = 0; i < WorkerCount; i++)
+			{
+				if (!Workers[i].Active.load())
+				{
+					StartWorker(i);
+					return;
+				}
+			}
+		}
+
 
 	public:
 		inline void StartThreadPool(NosLib::FunctionStoreBase* threadFunction, const bool& detachThread = false, const float& threadMultiplier = 1, const unsigned int& customThreadCount = 0)
 		{
+			{
+				std::lock_guard<std::mutex> lk(threadJoinMutex);
+				if (PoolRunning)
+				{
+					throw std::logic_error("Thread Pool is already running");
+				}
+				PoolRunning = true;
+			}
+
 			ThreadFunction = threadFunction;
 			ThreadMultiplier = threadMultiplier;
 			CustomThreadCount = customThreadCount;
@@ -92,11 +757,508 @@ namespace NosLib
 			StartThreadPool(new ThreadFunctionType(threadFunction), detachThread, threadMultiplier, customThreadCount);
 		}
 
-		/* Will wait for the thread pool to be finished */
+		/// <summary>
+		/// Sets how threads started after this get pinned to cpus
+		/// </summary>
+		/// <param name="affinity">- affinity mode</param>
+		inline void SetAffinity(const Affinity& affinity)
+		{
+			ThreadAffinity = affinity;
+		}
+
+		/// <summary>
+		/// Sets the prefix used to name threads, so they can be told apart in profilers and debuggers
+		/// </summary>
+		/// <param name="threadNamePrefix">- name prefix (keep it short, linux only allows 15 characters in total)</param>
+		inline void SetThreadNamePrefix(const std::string& threadNamePrefix)
+		{
+			ThreadNamePrefix = threadNamePrefix;
+		}
+
+		/// <summary>
+		/// Sets if the default thread count should respect the process affinity mask and cgroup cpu quota
+		/// </summary>
+		/// <param name="respectCpuLimits">- if limits should be respected</param>
+		inline void SetRespectCpuLimits(const bool& respectCpuLimits)
+		{
+			RespectCpuLimits = respectCpuLimits;
+		}
+
+		/// <summary>
+		/// Starts persistent workers which run tasks given through Submit. each worker owns a work stealing deque,
+		/// tasks submitted from inside a worker go into its own deque and idle workers steal from random other workers
+		/// </summary>
+		/// <param name="threadMultiplier">(default = 1) - multiplier applied to the core count</param>
+		/// <param name="customThreadCount">(default = 0) - exact amount of workers (0 to use the core count)</param>
+		inline void StartWorkers(const float& threadMultiplier = 1, const unsigned int& customThreadCount = 0)
+		{
+			ThreadMultiplier = threadMultiplier;
+			CustomThreadCount = customThreadCount;
+
+			unsigned int workerCount = GetAmountOfCores();
+			LaunchWorkers(workerCount, workerCount, std::chrono::steady_clock::duration::zero());
+		}
+
+		/// <summary>
+		/// Starts workers which grow and shrink with the load. the pool starts with minWorkers, grows (up to maxWorkers) when tasks get submitted
+		/// while every worker is busy and workers retire after being parked for idleTimeout
+		/// </summary>
+		/// <param name="minWorkers">- workers which always stay running (can be 0)</param>
+		/// <param name="maxWorkers">(default = 0) - most workers at once (0 to use the core count)</param>
+		/// <param name="idleTimeout">(default = 5 seconds) - how long a worker stays parked before retiring</param>
+		inline void StartAdaptiveWorkers(const unsigned int& minWorkers, const unsigned int& maxWorkers = 0, const std::chrono::steady_clock::duration& idleTimeout = std::chrono::seconds(5))
+		{
+			ThreadMultiplier = 1;
+			CustomThreadCount = maxWorkers;
+
+			unsigned int workerCount = GetAmountOfCores();
+			LaunchWorkers(std::min(minWorkers, workerCount), workerCount, idleTimeout);
+		}
+
+		/// <summary>
+		/// Sets the most a worker spins looking for work before parking. workers adapt their spin between a small minimum and this
+		/// </summary>
+		/// <param name="maxSpinCount">- most spin iterations (0 to always park straight away)</param>
+		inline void SetMaxSpinCount(const unsigned int& maxSpinCount)
+		{
+			MaxSpinCount.store(maxSpinCount);
+		}
+
+		/// <summary>
+		/// Finishes all queued tasks and stops the workers
+		/// </summary>
+		inline void StopWorkers()
+		{
+			if (Workers == nullptr)
+			{
+				return;
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(SleepMutex);
+				StopRequested.store(true);
+			}
+			SleepCV.notify_all();
+
+			{ std::lock_guard<std::mutex> lock(GrowMutex); } /* any worker being started right now finishes starting, later ones see StopRequested */
+
+			for (unsigned int i = 0; i < WorkerCount; i++)
+			{
+				if (Workers[i].Thread.joinable())
+				{
+					Workers[i].Thread.join();
+					NOSLIB_LOG(NosLib::Logging::Severity::Debug, "Worker {} finished", i);
+				}
+			}
+
+			delete[] Workers;
+			Workers = nullptr;
+			WorkerCount = 0;
+			ActiveWorkerCount.store(0);
+		}
+
+		/// <summary>
+		/// Submits a task to the workers (StartWorkers has to be called first)
+		/// </summary>
+		/// <typeparam name="Callable">- any callable taking no arguments</typeparam>
+		/// <param name="task">- the task</param>
+		/// <param name="priority">(default = Priority::Normal) - task priority</param>
+		template<class Callable>
+		inline void Submit(Callable&& task, const Priority& priority = Priority::Normal)
+		{
+			PoolTask* poolTask = new PoolTask();
+			poolTask->Function = std::forward<Callable>(task);
+			poolTask->TaskPriority = priority;
+			EnqueueTask(poolTask);
+		}
+
+		template<class FuncType, typename ... VariadicArgs>
+		inline void Submit(const NosLib::FunctionStore<FuncType, VariadicArgs...>& task, const Priority& priority = Priority::Normal)
+		{
+			Submit([task]() { task.RunFunction(); }, priority);
+		}
+
+		template<class ObjectType, class FuncType, typename ... VariadicArgs>
+		inline void Submit(const NosLib::MemberFunctionStore<ObjectType, FuncType, VariadicArgs...>& task, const Priority& priority = Priority::Normal)
+		{
+			Submit([task]() { task.RunFunction(); }, priority);
+		}
+
+		/// <summary>
+		/// Submits a task which gets dropped if it hasn't started running before the deadline
+		/// </summary>
+		/// <typeparam name="Callable">- any callable taking no arguments</typeparam>
+		/// <param name="deadline">- latest time the task is still worth starting</param>
+		/// <param name="task">- the task</param>
+		/// <param name="priority">(default = Priority::Normal) - task priority</param>
+		/// <param name="onExpired">(default = nullptr) - called on a worker instead of the task if the deadline passed</param>
+		template<class Callable>
+		inline void SubmitWithDeadline(const std::chrono::steady_clock::time_point& deadline, Callable&& task, const Priority& priority = Priority::Normal, const std::function<void()>& onExpired = nullptr)
+		{
+			PoolTask* poolTask = new PoolTask();
+			poolTask->Function = std::forward<Callable>(task);
+			poolTask->TaskPriority = priority;
+			poolTask->Deadline = deadline;
+			poolTask->OnExpired = onExpired;
+			EnqueueTask(poolTask);
+		}
+
+		/// <summary>
+		/// Sets how long a lower priority task can wait before it gets picked ahead of higher priority ones
+		/// </summary>
+		/// <param name="starvationLimit">- longest wait before promotion</param>
+		template<class Rep, class Period>
+		inline void SetStarvationLimit(const std::chrono::duration<Rep, Period>& starvationLimit)
+		{
+			std::lock_guard<std::mutex> lock(InjectionMutex);
+			StarvationLimit = std::chrono::duration_cast<std::chrono::steady_clock::duration>(starvationLimit);
+		}
+
+		/// <summary>
+		/// amount of tasks which got dropped because their deadline passed
+		/// </summary>
+		/// <returns>expired task count</returns>
+		inline uint64_t GetExpiredTaskCount() const
+		{
+			return ExpiredTaskCount.load();
+		}
+
+		/// <summary>
+		/// Runs a single queued task on the calling thread. lets a task waiting on its children help instead of blocking a worker
+		/// </summary>
+		/// <returns>if a task was run</returns>
+		inline bool TryRunPendingTask()
+		{
+			PoolTask* task = FindTask(CurrentPool == this ? CurrentWorker : nullptr);
+			if (task == nullptr)
+			{
+				return false;
+			}
+
+			RunTask(task, StatisticsFor(CurrentPool == this ? CurrentWorker : nullptr));
+			return true;
+		}
+
+		/// <summary>
+		/// amount of workers currently running
+		/// </summary>
+		/// <returns>worker count</returns>
+		inline unsigned int GetWorkerCount() const
+		{
+			return ActiveWorkerCount.load();
+		}
+
+		/// <summary>
+		/// most workers the pool can run at once (same as GetWorkerCount unless started with StartAdaptiveWorkers)
+		/// </summary>
+		/// <returns>max worker count</returns>
+		inline unsigned int GetMaxWorkerCount() const
+		{
+			return WorkerCount;
+		}
+
+		/// <summary>
+		/// Runs function over [begin, end) on the workers. the calling thread takes part and only returns once every iteration is done.
+		/// if the range is not bigger then grainSize (or no workers are running) it just runs inline
+		/// </summary>
+		/// <typeparam name="IndexType">- integral index type</typeparam>
+		/// <typeparam name="Callable">- either function(index) or function(chunkBegin, chunkEnd)</typeparam>
+		/// <param name="begin">- first index</param>
+		/// <param name="end">- one past the last index</param>
+		/// <param name="grainSize">- smallest amount of iterations given out at once</param>
+		/// <param name="function">- the loop body</param>
+		/// <param name="partitioning">(default = Partitioning::Dynamic) - how the range gets split up</param>
+		template<typename IndexType, class Callable>
+		inline void ParallelFor(const IndexType& begin, const IndexType& end, const IndexType& grainSize, Callable&& function, const Partitioning& partitioning = Partitioning::Dynamic)
+		{
+			static_assert(std::is_integral_v<IndexType>, "ParallelFor index has to be an integral type");
+
+			if (end <= begin)
+			{
+				return;
+			}
+
+			IndexType grain = (grainSize > 0 ? grainSize : 1);
+			IndexType total = end - begin;
+
+			auto runChunk = [&function](const IndexType& chunkBegin, const IndexType& chunkEnd)
+			{
+				if constexpr (std::is_invocable_v<Callable&, IndexType, IndexType>)
+				{
+					function(chunkBegin, chunkEnd);
+				}
+				else
+				{
+					for (IndexType i = chunkBegin; i < chunkEnd; i++)
+					{
+						function(i);
+					}
+				}
+			};
+
+			if (WorkerCount == 0 || total <= grain) /* not worth splitting */
+			{
+				runChunk(begin, end);
+				return;
+			}
+
+			/* workers plus the calling thread, but never more participants then chunks */
+			IndexType maxChunks = (total + grain - 1) / grain;
+			unsigned int participants = (unsigned int)std::min<uint64_t>((uint64_t)WorkerCount + 1, (uint64_t)maxChunks);
+
+			std::atomic<IndexType> nextIndex = begin; /* Dynamic/Guided: next unclaimed iteration */
+
+			auto participant = [&](const unsigned int& participantIndex)
+			{
+				switch (partitioning)
+				{
+				case Partitioning::Static:
+				{
+					IndexType blockSize = total / participants;
+					IndexType leftOver = total % participants;
+					IndexType blockBegin = begin + (IndexType)(participantIndex * blockSize) + (IndexType)std::min<uint64_t>(participantIndex, (uint64_t)leftOver);
+					IndexType blockEnd = blockBegin + blockSize + (participantIndex < (uint64_t)leftOver ? 1 : 0);
+					runChunk(blockBegin, blockEnd);
+					break;
+				}
+				case Partitioning::Dynamic:
+					while (true)
+					{
+						IndexType chunkBegin = nextIndex.fetch_add(grain);
+						if (chunkBegin >= end || chunkBegin < begin) /* second check catches wrap around */
+						{
+							break;
+						}
+						runChunk(chunkBegin, (end - chunkBegin > grain ? chunkBegin + grain : end));
+					}
+					break;
+				case Partitioning::Guided:
+					while (true)
+					{
+						IndexType chunkBegin = nextIndex.load();
+						IndexType chunkSize;
+						do
+						{
+							if (chunkBegin >= end)
+							{
+								break;
+							}
+							chunkSize = std::max<IndexType>((end - chunkBegin) / (IndexType)(participants * 2), grain);
+							chunkSize = std::min<IndexType>(chunkSize, end - chunkBegin);
+						} while (!nextIndex.compare_exchange_weak(chunkBegin, chunkBegin + chunkSize));
+
+						if (chunkBegin >= end)
+						{
+							break;
+						}
+						runChunk(chunkBegin, chunkBegin + chunkSize);
+					}
+					break;
+				}
+			};
+
+			TaskGroup group(this); /* destructor still waits for the others if participant(0) throws */
+			for (unsigned int i = 1; i < participants; i++)
+			{
+				group.Run([&participant, i]() { participant(i); });
+			}
+
+			participant(0);
+			group.Wait();
+		}
+
+		/// <summary>
+		/// Waits until every submitted task has finished running (including tasks submitted by those tasks).
+		/// can't be called from the pool's own workers, use a TaskGroup there
+		/// </summary>
+		inline void WaitIdle()
+		{
+			if (CurrentPool == this)
+			{
+				throw std::logic_error("WaitIdle cannot be called from one of the pool's own workers, use a TaskGroup instead");
+			}
+
+			std::unique_lock<std::mutex> lock(IdleMutex);
+			IdleCV.wait(lock, [this]() { return PendingTaskCount.load() == 0; });
+		}
+
+		/// <summary>
+		/// Waits until every submitted task has finished running or the timeout runs out
+		/// </summary>
+		/// <param name="timeout">- longest time to wait</param>
+		/// <returns>true if the pool went idle, false if it timed out</returns>
+		template<class Rep, class Period>
+		inline bool WaitIdleFor(const std::chrono::duration<Rep, Period>& timeout)
+		{
+			if (CurrentPool == this)
+			{
+				throw std::logic_error("WaitIdleFor cannot be called from one of the pool's own workers, use a TaskGroup instead");
+			}
+
+			std::unique_lock<std::mutex> lock(IdleMutex);
+			return IdleCV.wait_for(lock, timeout, [this]() { return PendingTaskCount.load() == 0; });
+		}
+
+		/// <summary>
+		/// amount of tasks which have been submitted but haven't finished yet
+		/// </summary>
+		/// <returns>pending task count</returns>
+		inline int64_t GetPendingTaskCount() const
+		{
+			return PendingTaskCount.load();
+		}
+
+		/// <summary>
+		/// Turns task timing (queue wait, execution time, busy time) on or off. counters are always kept, timing costs 2 clock reads per task
+		/// </summary>
+		/// <param name="enabled">- if timings should be recorded</param>
+		inline void SetStatisticsEnabled(const bool& enabled)
+		{
+			StatisticsEnabled.store(enabled);
+		}
+
+		/// <summary>
+		/// Statistics of a single worker, values can be read while the pool is running
+		/// </summary>
+		/// <param name="workerIndex">- worker index (0 to GetWorkerCount()-1)</param>
+		/// <returns>the worker's statistics</returns>
+		inline const NosLib::WorkerStatistics& GetWorkerStatistics(const unsigned int& workerIndex) const
+		{
+			if (workerIndex >= WorkerCount)
+			{
+				throw std::out_of_range(std::format("Worker index {} is out of range (worker count is {})", workerIndex, WorkerCount));
+			}
+
+			return Workers[workerIndex].Statistics;
+		}
+
+		/// <summary>
+		/// Statistics of tasks run by threads which aren't workers
+		/// </summary>
+		/// <returns>external statistics</returns>
+		inline const NosLib::WorkerStatistics& GetExternalStatistics() const
+		{
+			return ExternalStatistics;
+		}
+
+		/// <summary>
+		/// queue wait times of every worker (and external threads) merged together
+		/// </summary>
+		/// <returns>merged histogram</returns>
+		inline NosLib::LatencyHistogram GetQueueWaitHistogram() const
+		{
+			NosLib::LatencyHistogram histogram(ExternalStatistics.QueueWait);
+			for (unsigned int i = 0; i < WorkerCount; i++)
+			{
+				histogram.Merge(Workers[i].Statistics.QueueWait);
+			}
+			return histogram;
+		}
+
+		/// <summary>
+		/// execution times of every worker (and external threads) merged together
+		/// </summary>
+		/// <returns>merged histogram</returns>
+		inline NosLib::LatencyHistogram GetExecutionHistogram() const
+		{
+			NosLib::LatencyHistogram histogram(ExternalStatistics.Execution);
+			for (unsigned int i = 0; i < WorkerCount; i++)
+			{
+				histogram.Merge(Workers[i].Statistics.Execution);
+			}
+			return histogram;
+		}
+
+		/// <summary>
+		/// average utilization of the workers
+		/// </summary>
+		/// <returns>between 0 and 1</returns>
+		inline double GetUtilization() const
+		{
+			if (WorkerCount == 0)
+			{
+				return 0;
+			}
+
+			double total = 0;
+			for (unsigned int i = 0; i < WorkerCount; i++)
+			{
+				total += Workers[i].Statistics.GetUtilization();
+			}
+			return total / WorkerCount;
+		}
+
+		/// <summary>
+		/// Resets every counter and histogram
+		/// </summary>
+		inline void ResetStatistics()
+		{
+			for (unsigned int i = 0; i < WorkerCount; i++)
+			{
+				Workers[i].Statistics.Reset();
+			}
+			ExternalStatistics.Reset();
+
+			for (int i = 0; i < PriorityCount; i++)
+			{
+				InjectionHighWater[i].store(0, std::memory_order_relaxed);
+			}
+			ExpiredTaskCount.store(0);
+		}
+
+		/// <summary>
+		/// Dumps every statistic as JSON, pool totals plus one object per worker
+		/// </summary>
+		/// <returns>JSON string</returns>
+		inline std::string GetStatisticsJson() const
+		{
+			std::string workersJson;
+			for (unsigned int i = 0; i < WorkerCount; i++)
+			{
+				workersJson += std::format("{}{{\"index\":{},\"statistics\":{}}}", (i == 0 ? "" : ","), i, Workers[i].Statistics.ToJson());
+			}
+
+			return std::format("{{\"worker_count\":{},\"active_workers\":{},\"pending_tasks\":{},\"queued_tasks\":{},\"expired_tasks\":{},\"utilization\":{:.4f},"
+							   "\"injection_high_water\":{{\"high\":{},\"normal\":{},\"background\":{}}},"
+							   "\"queue_wait\":{},\"execution\":{},\"external\":{},\"workers\":[{}]}}",
+							   WorkerCount, ActiveWorkerCount.load(), PendingTaskCount.load(), QueuedTaskCount.load(), ExpiredTaskCount.load(), GetUtilization(),
+							   InjectionHighWater[(int)Priority::High].load(), InjectionHighWater[(int)Priority::Normal].load(), InjectionHighWater[(int)Priority::Background].load(),
+							   GetQueueWaitHistogram().ToJson(), GetExecutionHistogram().ToJson(), ExternalStatistics.ToJson(), workersJson);
+		}
+
+		inline ~ThreadPool()
+		{
+			JoinThreadPool();
+			StopWorkers();
+		}
+
+		/* Will wait for the thread pool to be finished, returns straight away if it isn't running */
 		inline void JoinThreadPool()
 		{
 			std::unique_lock<std::mutex> lk(threadJoinMutex);
-			threadJoinCV.wait(lk);
+			threadJoinCV.wait(lk, [this]() { return !PoolRunning; });
+		}
+
+		/// <summary>
+		/// Waits for the thread pool to be finished or the timeout to run out
+		/// </summary>
+		/// <param name="timeout">- longest time to wait</param>
+		/// <returns>true if the thread pool finished, false if it timed out</returns>
+		template<class Rep, class Period>
+		inline bool JoinThreadPoolFor(const std::chrono::duration<Rep, Period>& timeout)
+		{
+			std::unique_lock<std::mutex> lk(threadJoinMutex);
+			return threadJoinCV.wait_for(lk, timeout, [this]() { return !PoolRunning; });
+		}
+
+		/// <summary>
+		/// if work started with StartThreadPool is still running
+		/// </summary>
+		/// <returns>if the thread pool is running</returns>
+		inline bool IsThreadPoolRunning()
+		{
+			std::lock_guard<std::mutex> lk(threadJoinMutex);
+			return PoolRunning;
 		}
 
 	protected:
@@ -107,7 +1269,8 @@ namespace NosLib
 				return CustomThreadCount;
 			}
 
-			unsigned int coreCount = std::thread::hardware_concurrency();
+			/* a container limited to 2 cpus on a 64 core machine shouldn't get 64 threads */
+			unsigned int coreCount = (RespectCpuLimits ? NosLib::Topology::GetUsableCoreCount() : std::thread::hardware_concurrency());
 
 			if (coreCount == 0)
 			{
@@ -121,6 +1284,102 @@ namespace NosLib
 
 			return coreCount;
 		}
+
+		/// <summary>
+		/// Works out which cpu each thread index gets pinned to, based on ThreadAffinity
+		/// </summary>
+		/// <param name="threadCount">- amount of threads about to be started</param>
+		/// <returns>cpu for each thread index, empty when not pinning</returns>
+		inline std::vector<unsigned int> BuildCpuPlan(const unsigned int& threadCount) const
+		{
+			std::vector<unsigned int> cpuPlan;
+
+			if (ThreadAffinity == Affinity::None || threadCount == 0)
+			{
+				return cpuPlan;
+			}
+
+			std::vector<std::vector<unsigned int>> nodes = NosLib::Topology::GetNumaNodes();
+
+			if (ThreadAffinity == Affinity::Compact)
+			{
+				for (const std::vector<unsigned int>& node : nodes)
+				{
+					cpuPlan.insert(cpuPlan.end(), node.begin(), node.end());
+				}
+				return cpuPlan;
+			}
+
+			/* Spread, take one cpu from each node in turn */
+			for (size_t depth = 0; cpuPlan.size() < threadCount; depth++)
+			{
+				bool anyLeft = false;
+				for (const std::vector<unsigned int>& node : nodes)
+				{
+					if (depth < node.size())
+					{
+						cpuPlan.push_back(node[depth]);
+						anyLeft = true;
+					}
+				}
+
+				if (!anyLeft)
+				{
+					break;
+				}
+			}
+			return cpuPlan;
+		}
+
+		/// <summary>
+		/// Names the calling thread and pins it according to cpuPlan
+		/// </summary>
+		/// <param name="threadName">- name for the thread</param>
+		/// <param name="cpuPlan">- plan of the mode the thread belongs to (JobCpuPlan or WorkerCpuPlan)</param>
+		/// <param name="threadIndex">- index of the thread inside the pool</param>
+		inline void PrepareCurrentThread(const std::string& threadName, const std::vector<unsigned int>& cpuPlan, const unsigned int& threadIndex)
+		{
+			NosLib::Topology::NameCurrentThread(threadName);
+
+			if (!cpuPlan.empty()) /* more threads then cpus wrap around */
+			{
+				NosLib::Topology::PinCurrentThread(cpuPlan[threadIndex % cpuPlan.size()]);
+			}
+		}
+
+		/// <summary>
+		/// Allocates the worker slots and starts the first workers
+		/// </summary>
+		/// <param name="startWorkers">- workers to start straight away (also the minimum)</param>
+		/// <param name="maxWorkers">- amount of slots</param>
+		/// <param name="idleTimeout">- how long a parked worker waits before retiring (zero never retires)</param>
+		inline void LaunchWorkers(const unsigned int& startWorkers, const unsigned int& maxWorkers, const std::chrono::steady_clock::duration& idleTimeout)
+		{
+			if (Workers != nullptr)
+			{
+				throw std::logic_error("Thread Pool workers are already running");
+			}
+
+			StopRequested.store(false);
+			MinWorkerCount = startWorkers;
+			WorkerIdleTimeout = idleTimeout;
+
+			WorkerCount = maxWorkers;
+			WorkerCpuPlan = BuildCpuPlan(WorkerCount); /* before any worker exists, GrowWorkers reads it for as long as the slots live */
+			Workers = new Worker[WorkerCount];
+
+			for (unsigned int i = 0; i < WorkerCount; i++)
+			{
+				Workers[i].Index = i;
+				Workers[i].RandomState = 0x9E3779B97F4A7C15ull * (i + 1);
+			}
+
+			std::lock_guard<std::mutex> lock(GrowMutex);
+			for (unsigned int i = 0; i < startWorkers; i++)
+			{
+				StartWorker(i);
+			}
+		}
 	};
 }
 
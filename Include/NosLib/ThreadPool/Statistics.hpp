@@ -0,0 +1,260 @@
+#ifndef _STATISTICS_NOSLIB_HPP_
+#define _STATISTICS_NOSLIB_HPP_
+
+#include <atomic>
+#include <string>
+#include <format>
+#include <cstdint>
+#include <bit>
+#include <chrono>
+
+namespace NosLib
+{
+	/// <summary>
+	/// HDR style log-linear histogram of nanosecond latencies. every power of 2 is split into 16 buckets (~6% worst case error),
+	/// recording is a handful of instructions and one relaxed atomic add, reading can happen from any thread
+	/// </summary>
+	class LatencyHistogram
+	{
+	public:
+		static constexpr int SubBucketBits = 4;
+		static constexpr uint64_t SubBucketCount = 1ull << SubBucketBits;
+		static constexpr int BucketCount = (64 - SubBucketBits + 1) * (int)SubBucketCount;
+
+	protected:
+		std::atomic<uint64_t> Counts[BucketCount] = {};
+		std::atomic<uint64_t> TotalCount = 0;
+		std::atomic<uint64_t> TotalNanoseconds = 0;
+		std::atomic<uint64_t> MaxNanoseconds = 0;
+
+		/// <summary>
+		/// which bucket a value falls into
+		/// </summary>
+		static inline constexpr int BucketIndex(const uint64_t& value)
+		{
+			if (value < SubBucketCount)
+			{
+				return (int)value;
+			}
+
+			int exponent = 63 - std::countl_zero(value);
+			uint64_t subBucket = value >> (exponent - SubBucketBits); /* between SubBucketCount and 2*SubBucketCount-1 */
+			return (exponent - SubBucketBits + 1) * (int)SubBucketCount + (int)(subBucket - SubBucketCount);
+		}
+
+		/// <summary>
+		/// highest value which lands in the bucket
+		/// </summary>
+		static inline constexpr uint64_t BucketUpperBound(const int& index)
+		{
+			if (index < (int)SubBucketCount)
+			{
+				return (uint64_t)index;
+			}
+
+			int exponent = index / (int)SubBucketCount - 1 + SubBucketBits;
+			uint64_t subBucket = (uint64_t)(index % SubBucketCount) + SubBucketCount;
+			int shift = exponent - SubBucketBits;
+			return ((subBucket + 1) << shift) - 1;
+		}
+
+	public:
+		inline LatencyHistogram() {}
+
+		inline LatencyHistogram(const LatencyHistogram& other)
+		{
+			Merge(other);
+		}
+
+		LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+		/// <summary>
+		/// Records one latency. meant to be called by a single thread (the owner), reads can come from anywhere
+		/// </summary>
+		/// <param name="nanoseconds">- the latency</param>
+		inline void Record(const uint64_t& nanoseconds)
+		{
+			Counts[BucketIndex(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+			TotalCount.fetch_add(1, std::memory_order_relaxed);
+			TotalNanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed);
+
+			uint64_t currentMax = MaxNanoseconds.load(std::memory_order_relaxed);
+			while (nanoseconds > currentMax && !MaxNanoseconds.compare_exchange_weak(currentMax, nanoseconds, std::memory_order_relaxed)) {}
+		}
+
+		/// <summary>
+		/// Adds all the counts from another histogram into this one
+		/// </summary>
+		/// <param name="other">- histogram to add</param>
+		inline void Merge(const LatencyHistogram& other)
+		{
+			for (int i = 0; i < BucketCount; i++)
+			{
+				uint64_t count = other.Counts[i].load(std::memory_order_relaxed);
+				if (count != 0)
+				{
+					Counts[i].fetch_add(count, std::memory_order_relaxed);
+				}
+			}
+
+			TotalCount.fetch_add(other.TotalCount.load(std::memory_order_relaxed), std::memory_order_relaxed);
+			TotalNanoseconds.fetch_add(other.TotalNanoseconds.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+			uint64_t otherMax = other.MaxNanoseconds.load(std::memory_order_relaxed);
+			uint64_t currentMax = MaxNanoseconds.load(std::memory_order_relaxed);
+			while (otherMax > currentMax && !MaxNanoseconds.compare_exchange_weak(currentMax, otherMax, std::memory_order_relaxed)) {}
+		}
+
+		inline void Reset()
+		{
+			for (int i = 0; i < BucketCount; i++)
+			{
+				Counts[i].store(0, std::memory_order_relaxed);
+			}
+			TotalCount.store(0, std::memory_order_relaxed);
+			TotalNanoseconds.store(0, std::memory_order_relaxed);
+			MaxNanoseconds.store(0, std::memory_order_relaxed);
+		}
+
+		inline uint64_t GetCount() const
+		{
+			return TotalCount.load(std::memory_order_relaxed);
+		}
+
+		inline uint64_t GetMax() const
+		{
+			return MaxNanoseconds.load(std::memory_order_relaxed);
+		}
+
+		inline double GetMean() const
+		{
+			uint64_t count = GetCount();
+			return (count == 0 ? 0.0 : (double)TotalNanoseconds.load(std::memory_order_relaxed) / (double)count);
+		}
+
+		/// <summary>
+		/// Value at a percentile (upper bound of the bucket it lands in)
+		/// </summary>
+		/// <param name="percentile">- percentile between 0 and 100</param>
+		/// <returns>latency in nanoseconds</returns>
+		inline uint64_t GetPercentile(const double& percentile) const
+		{
+			uint64_t count = GetCount();
+			if (count == 0)
+			{
+				return 0;
+			}
+
+			uint64_t target = (uint64_t)((percentile / 100.0) * (double)count + 0.5);
+			target = (target == 0 ? 1 : (target > count ? count : target));
+
+			uint64_t seen = 0;
+			for (int i = 0; i < BucketCount; i++)
+			{
+				seen += Counts[i].load(std::memory_order_relaxed);
+				if (seen >= target)
+				{
+					uint64_t upperBound = BucketUpperBound(i);
+					uint64_t max = GetMax();
+					return (upperBound < max ? upperBound : max);
+				}
+			}
+
+			return GetMax();
+		}
+
+		/// <summary>
+		/// Summary as a JSON object (count, mean, p50, p90, p99, p99.9 and max, all in nanoseconds)
+		/// </summary>
+		/// <returns>JSON string</returns>
+		inline std::string ToJson() const
+		{
+			return std::format("{{\"count\":{},\"mean_ns\":{:.1f},\"p50_ns\":{},\"p90_ns\":{},\"p99_ns\":{},\"p999_ns\":{},\"max_ns\":{}}}",
+							   GetCount(), GetMean(), GetPercentile(50), GetPercentile(90), GetPercentile(99), GetPercentile(99.9), GetMax());
+		}
+	};
+
+	/// <summary>
+	/// counters kept by each ThreadPool worker. only the owning worker writes, anyone can read
+	/// </summary>
+	struct WorkerStatistics
+	{
+		std::atomic<uint64_t> TasksExecuted = 0;		/* tasks run (including expired ones) */
+		std::atomic<uint64_t> StealCount = 0;			/* tasks taken from other workers */
+		std::atomic<uint64_t> BusyNanoseconds = 0;		/* time spent running tasks */
+		std::atomic<int64_t> QueueHighWater = 0;		/* largest the local deque has been */
+		std::atomic<int64_t> SinceNanoseconds = Now();	/* steady clock time counting started (creation or last Reset) */
+		LatencyHistogram QueueWait;						/* time between submit and start */
+		LatencyHistogram Execution;						/* time spent inside the task */
+
+		/// <summary>
+		/// steady clock time in nanoseconds, what every statistic is measured with
+		/// </summary>
+		static inline int64_t Now()
+		{
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+		}
+
+		/// <summary>
+		/// time since counting started which wasn't spent running tasks (a task still running counts as idle until it finishes)
+		/// </summary>
+		/// <returns>idle time in nanoseconds</returns>
+		inline uint64_t GetIdleNanoseconds() const
+		{
+			int64_t elapsed = Now() - SinceNanoseconds.load(std::memory_order_relaxed);
+			int64_t busy = (int64_t)BusyNanoseconds.load(std::memory_order_relaxed);
+			return (uint64_t)(elapsed > busy ? elapsed - busy : 0);
+		}
+
+		/// <summary>
+		/// fraction of time spent running tasks
+		/// </summary>
+		/// <returns>between 0 and 1</returns>
+		inline double GetUtilization() const
+		{
+			int64_t elapsed = Now() - SinceNanoseconds.load(std::memory_order_relaxed);
+			if (elapsed <= 0)
+			{
+				return 0;
+			}
+			double utilization = (double)BusyNanoseconds.load(std::memory_order_relaxed) / (double)elapsed;
+			return (utilization > 1 ? 1 : utilization);
+		}
+
+		/// <summary>
+		/// bumps QueueHighWater if depth is higher
+		/// </summary>
+		/// <param name="depth">- current queue depth</param>
+		inline void UpdateHighWater(const int64_t& depth)
+		{
+			if (depth > QueueHighWater.load(std::memory_order_relaxed))
+			{
+				QueueHighWater.store(depth, std::memory_order_relaxed);
+			}
+		}
+
+		inline void Reset()
+		{
+			TasksExecuted.store(0, std::memory_order_relaxed);
+			StealCount.store(0, std::memory_order_relaxed);
+			BusyNanoseconds.store(0, std::memory_order_relaxed);
+			QueueHighWater.store(0, std::memory_order_relaxed);
+			SinceNanoseconds.store(Now(), std::memory_order_relaxed);
+			QueueWait.Reset();
+			Execution.Reset();
+		}
+
+		/// <summary>
+		/// Counters as a JSON object
+		/// </summary>
+		/// <returns>JSON string</returns>
+		inline std::string ToJson() const
+		{
+			return std::format("{{\"tasks_executed\":{},\"steals\":{},\"busy_ns\":{},\"idle_ns\":{},\"utilization\":{:.4f},\"queue_high_water\":{},\"queue_wait\":{},\"execution\":{}}}",
+							   TasksExecuted.load(std::memory_order_relaxed), StealCount.load(std::memory_order_relaxed), BusyNanoseconds.load(std::memory_order_relaxed),
+							   GetIdleNanoseconds(), GetUtilization(), QueueHighWater.load(std::memory_order_relaxed), QueueWait.ToJson(), Execution.ToJson());
+		}
+	};
+}
+
+#endif /* _STATISTICS_NOSLIB_HPP_ */
@@ -0,0 +1,291 @@
+#ifndef _TOPOLOGY_NOSLIB_HPP_
+#define _TOPOLOGY_NOSLIB_HPP_
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif // _WIN32
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <thread>
+#include <cmath>
+#include <cctype>
+#include <cstdint>
+
+namespace NosLib
+{
+	/// <summary>
+	/// namespace for finding out which CPUs the process can use and placing threads on them
+	/// </summary>
+	namespace Topology
+	{
+		/// <summary>
+		/// Parses linux cpu list format ("0-3,8,10-11")
+		/// </summary>
+		/// <param name="cpuList">- the list</param>
+		/// <returns>every cpu in the list</returns>
+		inline std::vector<unsigned int> ParseCpuList(const std::string& cpuList)
+		{
+			std::vector<unsigned int> cpus;
+			size_t position = 0;
+
+			while (position < cpuList.size())
+			{
+				size_t comma = cpuList.find(',', position);
+				std::string range = cpuList.substr(position, (comma == std::string::npos ? cpuList.size() : comma) - position);
+				position = (comma == std::string::npos ? cpuList.size() : comma + 1);
+
+				if (range.empty() || !std::isdigit((unsigned char)range[0]))
+				{
+					continue;
+				}
+
+				size_t dash = range.find('-');
+				unsigned int first = (unsigned int)std::stoul(range.substr(0, dash));
+				unsigned int last = (dash == std::string::npos ? first : (unsigned int)std::stoul(range.substr(dash + 1)));
+
+				for (unsigned int cpu = first; cpu <= last; cpu++)
+				{
+					cpus.push_back(cpu);
+				}
+			}
+
+			return cpus;
+		}
+
+		/// <summary>
+		/// CPUs the process is allowed to run on (respects taskset, cpusets, etc)
+		/// </summary>
+		/// <returns>sorted list of cpu ids</returns>
+		inline std::vector<unsigned int> GetAllowedCpus()
+		{
+			std::vector<unsigned int> cpus;
+
+		#ifdef _WIN32
+			DWORD_PTR processMask = 0, systemMask = 0;
+			if (GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask))
+			{
+				for (unsigned int cpu = 0; cpu < sizeof(DWORD_PTR) * 8; cpu++)
+				{
+					if (processMask & ((DWORD_PTR)1 << cpu))
+					{
+						cpus.push_back(cpu);
+					}
+				}
+			}
+		#else
+			cpu_set_t cpuSet;
+			CPU_ZERO(&cpuSet);
+			if (sched_getaffinity(0, sizeof(cpuSet), &cpuSet) == 0)
+			{
+				for (unsigned int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+				{
+					if (CPU_ISSET(cpu, &cpuSet))
+					{
+						cpus.push_back(cpu);
+					}
+				}
+			}
+		#endif // _WIN32
+
+			if (cpus.empty()) /* couldn't ask the OS, assume everything */
+			{
+				unsigned int coreCount = std::thread::hardware_concurrency();
+				for (unsigned int cpu = 0; cpu < coreCount; cpu++)
+				{
+					cpus.push_back(cpu);
+				}
+			}
+
+			return cpus;
+		}
+
+		/// <summary>
+		/// Allowed CPUs grouped by NUMA node. machines without NUMA info come back as a single node
+		/// </summary>
+		/// <returns>one list of cpu ids per node (empty nodes are left out)</returns>
+		inline std::vector<std::vector<unsigned int>> GetNumaNodes()
+		{
+			std::vector<unsigned int> allowedCpus = GetAllowedCpus();
+			std::vector<std::vector<unsigned int>> nodes;
+
+			auto keepAllowed = [&allowedCpus](const std::vector<unsigned int>& nodeCpus)
+			{
+				std::vector<unsigned int> kept;
+				for (unsigned int cpu : nodeCpus)
+				{
+					if (std::binary_search(allowedCpus.begin(), allowedCpus.end(), cpu))
+					{
+						kept.push_back(cpu);
+					}
+				}
+				return kept;
+			};
+
+		#ifdef _WIN32
+			ULONG highestNode = 0;
+			if (GetNumaHighestNodeNumber(&highestNode))
+			{
+				for (USHORT node = 0; node <= highestNode; node++)
+				{
+					GROUP_AFFINITY affinity = {};
+					if (!GetNumaNodeProcessorMaskEx(node, &affinity) || affinity.Group != 0) /* only processor group 0, same as GetAllowedCpus */
+					{
+						continue;
+					}
+
+					std::vector<unsigned int> nodeCpus;
+					for (unsigned int cpu = 0; cpu < sizeof(KAFFINITY) * 8; cpu++)
+					{
+						if (affinity.Mask & ((KAFFINITY)1 << cpu))
+						{
+							nodeCpus.push_back(cpu);
+						}
+					}
+
+					nodeCpus = keepAllowed(nodeCpus);
+					if (!nodeCpus.empty())
+					{
+						nodes.push_back(nodeCpus);
+					}
+				}
+			}
+		#else
+			std::error_code error;
+			std::vector<std::filesystem::path> nodeDirectories;
+			for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator("/sys/devices/system/node", error))
+			{
+				std::string name = entry.path().filename().string();
+				if (name.rfind("node", 0) == 0 && name.size() > 4 && std::isdigit((unsigned char)name[4]))
+				{
+					nodeDirectories.push_back(entry.path());
+				}
+			}
+
+			/* node10 has to come after node9 */
+			std::sort(nodeDirectories.begin(), nodeDirectories.end(), [](const std::filesystem::path& left, const std::filesystem::path& right)
+			{
+				return std::stoul(left.filename().string().substr(4)) < std::stoul(right.filename().string().substr(4));
+			});
+
+			for (const std::filesystem::path& nodeDirectory : nodeDirectories)
+			{
+				std::ifstream cpuListFile(nodeDirectory / "cpulist");
+				std::string cpuList;
+				std::getline(cpuListFile, cpuList);
+
+				std::vector<unsigned int> nodeCpus = keepAllowed(ParseCpuList(cpuList));
+				if (!nodeCpus.empty())
+				{
+					nodes.push_back(nodeCpus);
+				}
+			}
+		#endif // _WIN32
+
+			if (nodes.empty())
+			{
+				nodes.push_back(allowedCpus);
+			}
+
+			return nodes;
+		}
+
+		/// <summary>
+		/// CPU quota given to the process by cgroups (containers), in cores
+		/// </summary>
+		/// <returns>amount of cores the quota allows, 0 if there is no quota</returns>
+		inline double GetCpuQuota()
+		{
+		#ifndef _WIN32
+			/* cgroup v2 - "max 100000" or "<quota> <period>" */
+			std::ifstream cpuMaxFile("/sys/fs/cgroup/cpu.max");
+			if (cpuMaxFile)
+			{
+				std::string quota;
+				double period = 0;
+				cpuMaxFile >> quota >> period;
+
+				if (quota != "max" && !quota.empty() && period > 0)
+				{
+					return std::stod(quota) / period;
+				}
+				return 0;
+			}
+
+			/* cgroup v1 */
+			std::ifstream quotaFile("/sys/fs/cgroup/cpu/cpu.cfs_quota_us");
+			std::ifstream periodFile("/sys/fs/cgroup/cpu/cpu.cfs_period_us");
+			double quota = -1, period = 0;
+			if (quotaFile >> quota && periodFile >> period && quota > 0 && period > 0)
+			{
+				return quota / period;
+			}
+		#endif // _WIN32
+
+			return 0;
+		}
+
+		/// <summary>
+		/// amount of threads worth running at once, smallest out of allowed cpus and the cgroup quota
+		/// </summary>
+		/// <returns>usable core count (at least 1)</returns>
+		inline unsigned int GetUsableCoreCount()
+		{
+			unsigned int coreCount = (unsigned int)GetAllowedCpus().size();
+			double quota = GetCpuQuota();
+
+			if (quota > 0)
+			{
+				coreCount = std::min(coreCount, (unsigned int)std::ceil(quota));
+			}
+
+			return std::max(coreCount, 1u);
+		}
+
+		/// <summary>
+		/// Pins the calling thread to a single cpu
+		/// </summary>
+		/// <param name="cpu">- cpu id</param>
+		/// <returns>if it succeeded</returns>
+		inline bool PinCurrentThread(const unsigned int& cpu)
+		{
+		#ifdef _WIN32
+			if (cpu >= sizeof(DWORD_PTR) * 8)
+			{
+				return false;
+			}
+			return SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu) != 0;
+		#else
+			if (cpu >= CPU_SETSIZE)
+			{
+				return false;
+			}
+			cpu_set_t cpuSet;
+			CPU_ZERO(&cpuSet);
+			CPU_SET(cpu, &cpuSet);
+			return pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) == 0;
+		#endif // _WIN32
+		}
+
+		/// <summary>
+		/// Names the calling thread so it shows up in debuggers and profilers (linux cuts it to 15 characters)
+		/// </summary>
+		/// <param name="name">- thread name</param>
+		inline void NameCurrentThread(const std::string& name)
+		{
+		#ifdef _WIN32
+			SetThreadDescription(GetCurrentThread(), std::wstring(name.begin(), name.end()).c_str());
+		#else
+			pthread_setname_np(pthread_self(), name.substr(0, 15).c_str());
+		#endif // _WIN32
+		}
+	}
+}
+
+#endif /* _TOPOLOGY_NOSLIB_HPP_ */
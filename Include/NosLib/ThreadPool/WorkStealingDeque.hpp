@@ -0,0 +1,208 @@
+#ifndef _WORKSTEALINGDEQUE_NOSLIB_HPP_
+#define _WORKSTEALINGDEQUE_NOSLIB_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+
+namespace NosLib
+{
+	/// <summary>
+	/// Chase-Lev work stealing deque. The owner thread pushes and pops from the bottom, any other thread can steal from the top
+	/// </summary>
+	/// <typeparam name="DequeDataType">- datatype stored in the deque (has to be trivially copyable, usually a pointer)</typeparam>
+	template<class DequeDataType>
+	class WorkStealingDeque
+	{
+		static_assert(std::is_trivially_copyable_v<DequeDataType>, "WorkStealingDeque can only store trivially copyable types (store pointers instead)");
+
+	private:
+		/// <summary>
+		/// power of 2 sized ring buffer which backs the deque
+		/// </summary>
+		class CircularArray
+		{
+		public:
+			int64_t Capacity;							/* amount of slots, always a power of 2 */
+			int64_t Mask;								/* Capacity - 1, used instead of modulo */
+			std::atomic<DequeDataType>* Data;			/* the slots */
+			CircularArray* Previous = nullptr;			/* array this one replaced. kept alive because thieves might still be reading from it */
+
+			inline CircularArray(const int64_t& capacity)
+			{
+				Capacity = capacity;
+				Mask = capacity - 1;
+				Data = new std::atomic<DequeDataType>[Capacity];
+			}
+
+			inline ~CircularArray()
+			{
+				delete[] Data;
+				delete Previous;
+			}
+
+			inline DequeDataType Get(const int64_t& index) const
+			{
+				return Data[index & Mask].load(std::memory_order_relaxed);
+			}
+
+			inline void Put(const int64_t& index, const DequeDataType& object)
+			{
+				Data[index & Mask].store(object, std::memory_order_relaxed);
+			}
+
+			/// <summary>
+			/// creates a new array double the size and copies over the live range
+			/// </summary>
+			/// <param name="bottom">- current bottom index</param>
+			/// <param name="top">- current top index</param>
+			/// <returns>the new array</returns>
+			inline CircularArray* Grow(const int64_t& bottom, const int64_t& top)
+			{
+				CircularArray* grownArray = new CircularArray(Capacity * 2);
+				for (int64_t i = top; i < bottom; i++)
+				{
+					grownArray->Put(i, Get(i));
+				}
+				grownArray->Previous = this;
+				return grownArray;
+			}
+		};
+
+		alignas(64) std::atomic<int64_t> Top;				/* steal end, only ever increases */
+		alignas(64) std::atomic<int64_t> Bottom;			/* owner end */
+		alignas(64) std::atomic<CircularArray*> Array;		/* current ring buffer */
+
+	public:
+		/// <summary>
+		/// Constructor
+		/// </summary>
+		/// <param name="startCapacity">(default = 256) - starting capacity, gets rounded up to a power of 2</param>
+		inline WorkStealingDeque(const int64_t& startCapacity = 256)
+		{
+			int64_t capacity = 1;
+			while (capacity < startCapacity)
+			{
+				capacity <<= 1;
+			}
+
+			Top.store(0, std::memory_order_relaxed);
+			Bottom.store(0, std::memory_order_relaxed);
+			Array.store(new CircularArray(capacity), std::memory_order_relaxed);
+		}
+
+		WorkStealingDeque(const WorkStealingDeque&) = delete;
+		WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+		inline ~WorkStealingDeque()
+		{
+			delete Array.load(std::memory_order_relaxed);
+		}
+
+		/// <summary>
+		/// Push object onto the bottom. ONLY the owner thread may call this
+		/// </summary>
+		/// <param name="object">- object to push</param>
+		inline void Push(const DequeDataType& object)
+		{
+			int64_t bottom = Bottom.load(std::memory_order_relaxed);
+			int64_t top = Top.load(std::memory_order_acquire);
+			CircularArray* array = Array.load(std::memory_order_relaxed);
+
+			if (bottom - top > array->Capacity - 1) /* full, grow */
+			{
+				array = array->Grow(bottom, top);
+				Array.store(array, std::memory_order_release);
+			}
+
+			array->Put(bottom, object);
+			Bottom.store(bottom + 1, std::memory_order_release); /* publishes the object to thieves */
+		}
+
+		/// <summary>
+		/// Pop object from the bottom (LIFO). ONLY the owner thread may call this
+		/// </summary>
+		/// <param name="out">- pointer which will get set to the popped object</param>
+		/// <returns>if an object was popped</returns>
+		inline bool Pop(DequeDataType* out)
+		{
+			int64_t bottom = Bottom.load(std::memory_order_relaxed) - 1;
+			CircularArray* array = Array.load(std::memory_order_relaxed);
+			Bottom.store(bottom, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			int64_t top = Top.load(std::memory_order_relaxed);
+
+			if (top > bottom) /* empty */
+			{
+				Bottom.store(bottom + 1, std::memory_order_relaxed);
+				return false;
+			}
+
+			DequeDataType object = array->Get(bottom);
+
+			if (top == bottom) /* last object, race against thieves for it */
+			{
+				bool won = Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+				Bottom.store(bottom + 1, std::memory_order_relaxed);
+
+				if (!won)
+				{
+					return false;
+				}
+			}
+
+			*out = object;
+			return true;
+		}
+
+		/// <summary>
+		/// Steal object from the top (FIFO). Can be called from any thread
+		/// </summary>
+		/// <param name="out">- pointer which will get set to the stolen object</param>
+		/// <returns>if an object was stolen (false if empty or if another thread won the race)</returns>
+		inline bool Steal(DequeDataType* out)
+		{
+			int64_t top = Top.load(std::memory_order_acquire);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			int64_t bottom = Bottom.load(std::memory_order_acquire);
+
+			if (top >= bottom) /* empty */
+			{
+				return false;
+			}
+
+			CircularArray* array = Array.load(std::memory_order_acquire);
+			DequeDataType object = array->Get(top);
+
+			if (!Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			{
+				return false;
+			}
+
+			*out = object;
+			return true;
+		}
+
+		/// <summary>
+		/// Approximate amount of objects in the deque (can be out of date as soon as it returns)
+		/// </summary>
+		/// <returns>approximate size</returns>
+		inline int64_t Size() const
+		{
+			int64_t bottom = Bottom.load(std::memory_order_relaxed);
+			int64_t top = Top.load(std::memory_order_relaxed);
+			return (bottom > top ? bottom - top : 0);
+		}
+
+		/// <summary>
+		/// if the deque is (approximately) empty
+		/// </summary>
+		/// <returns>if the deque is empty</returns>
+		inline bool Empty() const
+		{
+			return Size() == 0;
+		}
+	};
+}
+
+#endif /* _WORKSTEALINGDEQUE_NOSLIB_HPP_ */
@@ -0,0 +1,191 @@
+#include <NosLib/ConcurrentQueue.hpp>
+
+#include <cstdio>
+#include <cstdint>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <chrono>
+
+/* throughput of the concurrent queues against a mutex + std::deque baseline. every run moves the same amount of items
+ * through the queue, producers split them evenly and consumers pop until all of them are out (checked by summing them) */
+
+constexpr uint64_t ItemCount = 4'000'000;
+constexpr size_t QueueCapacity = 1024;
+constexpr size_t BatchSize = 64;
+
+/* the baseline, bounded like the others so producers can't just run ahead */
+class MutexDequeQueue
+{
+private:
+	std::mutex QueueMutex;
+	std::deque<uint64_t> Items;
+	size_t Capacity;
+
+public:
+	inline MutexDequeQueue(const size_t& capacity)
+		: Capacity(capacity) {}
+
+	inline bool TryPush(const uint64_t& item)
+	{
+		std::lock_guard<std::mutex> lock(QueueMutex);
+		if (Items.size() == Capacity)
+		{
+			return false;
+		}
+		Items.push_back(item);
+		return true;
+	}
+
+	inline bool TryPop(uint64_t& out)
+	{
+		std::lock_guard<std::mutex> lock(QueueMutex);
+		if (Items.empty())
+		{
+			return false;
+		}
+		out = Items.front();
+		Items.pop_front();
+		return true;
+	}
+};
+
+/// <summary>
+/// Runs producers and consumers over one queue
+/// </summary>
+/// <param name="producer">- called as producer(queue, first, count), has to push items first .. first + count - 1</param>
+/// <param name="consumer">- called as consumer(queue, popped, sum) until popped reaches ItemCount, adds what it pops to both</param>
+template<class QueueType, class Producer, class Consumer>
+void Run(const char* name, const unsigned int& producerCount, const unsigned int& consumerCount, Producer producer, Consumer consumer)
+{
+	QueueType queue(QueueCapacity);
+	std::atomic<uint64_t> popped = 0;
+	std::atomic<uint64_t> sum = 0;
+	std::vector<std::thread> threads;
+
+	auto start = std::chrono::steady_clock::now();
+	for (unsigned int i = 0; i < producerCount; i++)
+	{
+		uint64_t first = ItemCount / producerCount * i;
+		uint64_t count = (i + 1 == producerCount ? ItemCount - first : ItemCount / producerCount);
+		threads.emplace_back([&queue, &producer, first, count]() { producer(queue, first, count); });
+	}
+	for (unsigned int i = 0; i < consumerCount; i++)
+	{
+		threads.emplace_back([&queue, &consumer, &popped, &sum]() { consumer(queue, popped, sum); });
+	}
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	bool correct = (sum.load() == ItemCount * (ItemCount - 1) / 2);
+	printf("%-22s %up/%uc  %7.2f M items/s%s\n", name, producerCount, consumerCount, ItemCount / seconds / 1e6, (correct ? "" : "  (WRONG SUM)"));
+}
+
+template<class QueueType>
+void PushOneByOne(QueueType& queue, const uint64_t& first, const uint64_t& count)
+{
+	NosLib::Backoff backoff;
+	for (uint64_t item = first; item < first + count; item++)
+	{
+		while (!queue.TryPush(item))
+		{
+			backoff.Pause();
+		}
+		backoff.Reset();
+	}
+}
+
+template<class QueueType>
+void PopOneByOne(QueueType& queue, std::atomic<uint64_t>& popped, std::atomic<uint64_t>& sum)
+{
+	NosLib::Backoff backoff;
+	uint64_t localSum = 0, item;
+	while (popped.load(std::memory_order_relaxed) < ItemCount)
+	{
+		if (queue.TryPop(item))
+		{
+			localSum += item;
+			popped.fetch_add(1, std::memory_order_relaxed);
+			backoff.Reset();
+		}
+		else
+		{
+			backoff.Pause();
+		}
+	}
+	sum.fetch_add(localSum);
+}
+
+template<class QueueType>
+void PushBatches(QueueType& queue, const uint64_t& first, const uint64_t& count)
+{
+	NosLib::Backoff backoff;
+	uint64_t batch[BatchSize];
+	for (uint64_t next = first; next < first + count;)
+	{
+		size_t batchCount = (size_t)std::min<uint64_t>(BatchSize, first + count - next);
+		for (size_t i = 0; i < batchCount; i++)
+		{
+			batch[i] = next + i;
+		}
+
+		for (size_t pushed = 0; pushed < batchCount;)
+		{
+			size_t claimed = queue.TryPushBatch(batch + pushed, batchCount - pushed);
+			if (claimed == 0)
+			{
+				backoff.Pause();
+				continue;
+			}
+			pushed += claimed;
+			backoff.Reset();
+		}
+		next += batchCount;
+	}
+}
+
+template<class QueueType>
+void PopBatches(QueueType& queue, std::atomic<uint64_t>& popped, std::atomic<uint64_t>& sum)
+{
+	NosLib::Backoff backoff;
+	uint64_t localSum = 0, batch[BatchSize];
+	while (popped.load(std::memory_order_relaxed) < ItemCount)
+	{
+		size_t count = queue.TryPopBatch(batch, BatchSize);
+		if (count == 0)
+		{
+			backoff.Pause();
+			continue;
+		}
+
+		for (size_t i = 0; i < count; i++)
+		{
+			localSum += batch[i];
+		}
+		popped.fetch_add(count, std::memory_order_relaxed);
+		backoff.Reset();
+	}
+	sum.fetch_add(localSum);
+}
+
+int main()
+{
+	printf("%llu items, capacity %zu, %u hardware threads\n\n", (unsigned long long)ItemCount, QueueCapacity, std::thread::hardware_concurrency());
+
+	Run<NosLib::SPSCQueue<uint64_t>>("SPSCQueue", 1, 1, PushOneByOne<NosLib::SPSCQueue<uint64_t>>, PopOneByOne<NosLib::SPSCQueue<uint64_t>>);
+	Run<NosLib::SPSCQueue<uint64_t>>("SPSCQueue batch", 1, 1, PushBatches<NosLib::SPSCQueue<uint64_t>>, PopBatches<NosLib::SPSCQueue<uint64_t>>);
+
+	for (unsigned int threads : {1u, 2u, 4u})
+	{
+		Run<MutexDequeQueue>("mutex + std::deque", threads, threads, PushOneByOne<MutexDequeQueue>, PopOneByOne<MutexDequeQueue>);
+		Run<NosLib::MPMCQueue<uint64_t>>("MPMCQueue", threads, threads, PushOneByOne<NosLib::MPMCQueue<uint64_t>>, PopOneByOne<NosLib::MPMCQueue<uint64_t>>);
+		Run<NosLib::MPMCQueue<uint64_t>>("MPMCQueue batch", threads, threads, PushBatches<NosLib::MPMCQueue<uint64_t>>, PopBatches<NosLib::MPMCQueue<uint64_t>>);
+	}
+
+	return 0;
+}